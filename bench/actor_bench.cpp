@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "actor.hpp"
+
+// --------------------------------------------------
+// Ping-pong: two actors bounce a counter back and forth.
+// Every hop is a send + a schedule onto the pool, so this
+// is the worst case for the actor layer (batch never > 1).
+// Args:
+//   0 -> pool workers
+//   1 -> round trips per iteration
+// --------------------------------------------------
+static void BM_Actor_PingPong(benchmark::State& state) {
+    const std::size_t workers = static_cast<std::size_t>(state.range(0));
+    const std::uint64_t trips = static_cast<std::uint64_t>(state.range(1));
+
+    stel::thread_pool pool(workers);
+    std::atomic<bool> done{false};
+
+    std::unique_ptr<stel::actor<std::uint64_t>> ping;
+    std::unique_ptr<stel::actor<std::uint64_t>> pong;
+    ping = std::make_unique<stel::actor<std::uint64_t>>(pool, [&](std::uint64_t& n) {
+        if (n == trips) {
+            done.store(true, std::memory_order_release);
+            done.notify_one();
+            return;
+        }
+        pong->send(n + 1);
+    });
+    pong = std::make_unique<stel::actor<std::uint64_t>>(pool, [&](std::uint64_t& n) {
+        ping->send(n);
+    });
+
+    for (auto _ : state) {
+        done.store(false, std::memory_order_relaxed);
+        ping->send(0);
+        done.wait(false, std::memory_order_acquire);
+    }
+    pool.wait_idle();
+
+    state.SetItemsProcessed(static_cast<int64_t>(trips * state.iterations()));
+    state.counters["s/roundtrip"] = benchmark::Counter(
+        static_cast<double>(trips * state.iterations()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_Actor_PingPong)
+    ->Args({2, 100000})
+    ->Args({4, 100000})
+    ->UseRealTime()
+    ->Iterations(3);
+
+// --------------------------------------------------
+// Fan-in: N sender threads flood a single actor.
+// Batching is what keeps this cheap - one schedule
+// drains up to `batch` messages.
+// Args:
+//   0 -> sender threads
+//   1 -> messages per sender per iteration
+//   2 -> actor batch size
+// --------------------------------------------------
+static void BM_Actor_FanIn(benchmark::State& state) {
+    const int senders = static_cast<int>(state.range(0));
+    const std::uint64_t msgs = static_cast<std::uint64_t>(state.range(1));
+    const std::size_t batch = static_cast<std::size_t>(state.range(2));
+
+    stel::thread_pool pool(4);
+    std::uint64_t received = 0; // actor-owned
+
+    {
+        stel::actor<std::uint64_t> sink(pool, [&](std::uint64_t& v) {
+            received += v;
+        }, batch);
+
+        for (auto _ : state) {
+            std::vector<std::thread> ts;
+            for (int s = 0; s < senders; ++s) {
+                ts.emplace_back([&] {
+                    for (std::uint64_t i = 0; i < msgs; ++i) sink.send(1);
+                });
+            }
+            for (auto& t : ts) t.join();
+            pool.wait_idle();
+        }
+    }
+    benchmark::DoNotOptimize(received);
+
+    state.SetItemsProcessed(static_cast<int64_t>(senders * msgs * state.iterations()));
+}
+BENCHMARK(BM_Actor_FanIn)
+    ->Args({1, 200000, 64})
+    ->Args({4, 50000, 64})
+    ->Args({8, 25000, 64})
+    ->Args({4, 50000, 1})        // no batching, one schedule per message
+    ->Args({4, 50000, 1024})
+    ->UseRealTime()
+    ->Iterations(3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+// Both loggers write to /dev/null so the numbers are about the logging path,
+// not the disk.
+
+// --------------------------------------------------
+// Per-call cost on the hot thread
+// Drops are reported - if the writer can't keep up the
+// call is cheap because the record is thrown away.
+// --------------------------------------------------
+static void BM_AsyncLogger_Call(benchmark::State& state) {
+    static std::unique_ptr<stel::async_logger> logger;
+    static int fd = -1;
+    if (state.thread_index() == 0) {
+        fd = ::open("/dev/null", O_WRONLY);
+        logger = std::make_unique<stel::async_logger>(fd, 1 << 16);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        logger->log("order {} filled qty={} px={} venue={}", i, 100, 101.25, "XNAS");
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        logger->flush();
+        state.counters["dropped"] = benchmark::Counter(double(logger->dropped()));
+        logger.reset();
+        ::close(fd);
+    }
+}
+BENCHMARK(BM_AsyncLogger_Call)->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+
+// Baseline: what the hot threads do today
+static void BM_MutexStream_Call(benchmark::State& state) {
+    static std::unique_ptr<std::ofstream> out;
+    static std::mutex m;
+    if (state.thread_index() == 0) {
+        out = std::make_unique<std::ofstream>("/dev/null");
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        std::lock_guard lock(m);
+        *out << "order " << i << " filled qty=" << 100 << " px=" << 101.25 << " venue=" << "XNAS" << '\n';
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        out.reset();
+    }
+}
+BENCHMARK(BM_MutexStream_Call)->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+
+// --------------------------------------------------
+// Sustained lines/s: log a burst and wait until it's
+// written out. The producer retries on a full ring so
+// nothing is dropped - this measures the writer side.
+// Args:
+//   0 -> lines per iteration
+// --------------------------------------------------
+static void BM_AsyncLogger_Sustained(benchmark::State& state) {
+    const std::size_t lines = static_cast<std::size_t>(state.range(0));
+    const int fd = ::open("/dev/null", O_WRONLY);
+    stel::async_logger logger(fd, 1 << 14, std::chrono::microseconds(10));
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < lines; ++i) {
+            while (!logger.log("order {} filled qty={} px={} venue={}", i, 100, 101.25, "XNAS")) {
+                benchmark::DoNotOptimize(i);
+            }
+        }
+        logger.flush();
+    }
+
+    state.counters["lines/s"] = benchmark::Counter(
+        static_cast<double>(lines * state.iterations()), benchmark::Counter::kIsRate);
+    ::close(fd);
+}
+BENCHMARK(BM_AsyncLogger_Sustained)->Arg(1 << 20)->Iterations(3)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "backoff.hpp"
+#include "lock_free_mpmc_bounded.hpp"
+#include "lock_free_spsc.hpp"
+
+// How the wait strategy in a spin loop affects throughput under contention,
+// and - where the RAPL counter is readable - energy per operation.
+//
+// Strategies (Arg 0):
+//   0 -> bare spin, nothing between retries
+//   1 -> one cpu_relax() per retry
+//   2 -> std::this_thread::yield() per retry
+//   3 -> stel::backoff
+
+enum strategy { bare = 0, relax = 1, yield = 2, adaptive = 3 };
+
+template <typename TryFn>
+static inline void retry(int s, TryFn&& try_once) {
+    stel::backoff b;
+    while (!try_once()) {
+        switch (s) {
+        case bare:     break;
+        case relax:    stel::cpu_relax(); break;
+        case yield:    std::this_thread::yield(); break;
+        case adaptive: b.pause(); break;
+        }
+    }
+}
+
+// Package energy in microjoules, or -1 if RAPL isn't exposed (VMs, non-Intel/AMD,
+// or no permission - energy_uj is root-only on recent kernels).
+static long long rapl_energy_uj() {
+    std::ifstream f("/sys/class/powercap/intel-rapl:0/energy_uj");
+    long long v = -1;
+    if (!(f >> v)) return -1;
+    return v;
+}
+
+struct energy_meter {
+    long long start = rapl_energy_uj();
+    void report(benchmark::State& state, double ops) const {
+        if (start < 0 || ops <= 0) return;
+        const long long end = rapl_energy_uj();
+        if (end < start) return; // counter wrapped
+        state.counters["nJ/op"] = static_cast<double>(end - start) * 1000.0 / ops;
+    }
+};
+
+// All threads bump one counter with a CAS loop - the worst kind of contention
+static void BM_Backoff_CasCounter(benchmark::State& state) {
+    static std::atomic<std::uint64_t> counter{0};
+    const int s = static_cast<int>(state.range(0));
+    energy_meter energy;
+
+    for (auto _ : state) {
+        retry(s, [] {
+            std::uint64_t v = counter.load(std::memory_order_relaxed);
+            return counter.compare_exchange_weak(v, v + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+        });
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        energy.report(state, static_cast<double>(state.iterations() * state.threads()));
+    }
+}
+BENCHMARK(BM_Backoff_CasCounter)->DenseRange(0, 3)->ThreadRange(1, 16)->UseRealTime();
+
+// MPMC ring, half the threads produce and half consume, each retrying on full/empty
+static void BM_Backoff_MPMC(benchmark::State& state) {
+    static std::unique_ptr<mpmc_bounded_queue<std::uint64_t>> q;
+    if (state.thread_index() == 0) {
+        q = std::make_unique<mpmc_bounded_queue<std::uint64_t>>(1024);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int s = static_cast<int>(state.range(0));
+    const bool producer = state.thread_index() % 2 == 0;
+    energy_meter energy;
+
+    std::uint64_t v = 0;
+    for (auto _ : state) {
+        if (producer) {
+            retry(s, [&] { return q->try_enqueue(v); });
+            ++v;
+        } else {
+            retry(s, [&] { return q->try_dequeue(v); });
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        energy.report(state, static_cast<double>(state.iterations() * state.threads()));
+    }
+}
+// Even thread counts only, so every item pushed is popped
+BENCHMARK(BM_Backoff_MPMC)->DenseRange(0, 3)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+
+// SPSC transfer of a fixed count; the spinning side is whichever is faster
+static void BM_Backoff_SPSC(benchmark::State& state) {
+    const int s = static_cast<int>(state.range(0));
+    constexpr std::uint64_t items = 1 << 20;
+    lock_free_spsc_queue<std::uint64_t> q(1024);
+    energy_meter energy;
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            std::uint64_t out = 0;
+            for (std::uint64_t i = 0; i < items; ++i) {
+                retry(s, [&] { return q.try_pop(out); });
+            }
+            benchmark::DoNotOptimize(out);
+        });
+        for (std::uint64_t i = 0; i < items; ++i) {
+            retry(s, [&] { return q.try_push(i); });
+        }
+        consumer.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+    energy.report(state, static_cast<double>(items * state.iterations()));
+}
+BENCHMARK(BM_Backoff_SPSC)->DenseRange(0, 3)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
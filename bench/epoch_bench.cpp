@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "epoch.hpp"
+
+struct node {
+    std::uint64_t value;
+    node* next;
+};
+
+// Threads of a multi-threaded run start at different times, so a domain can't be
+// rebuilt per run by thread 0 - one long-lived domain per scan_every setting.
+static stel::epoch_domain& domain(std::size_t scan_every) {
+    static std::mutex m;
+    static std::map<std::size_t, std::unique_ptr<stel::epoch_domain>> domains;
+    std::lock_guard lock(m);
+    auto& d = domains[scan_every];
+    if (!d) d = std::make_unique<stel::epoch_domain>(64, scan_every);
+    return *d;
+}
+
+// Cost of entering and leaving a critical section
+static void BM_Epoch_PinUnpin(benchmark::State& state) {
+    {
+        auto h = domain(64).register_thread();
+        for (auto _ : state) {
+            auto g = h.pin();
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Epoch_PinUnpin)->ThreadRange(1, 32)->UseRealTime();
+
+// pin + allocate + retire, the way a pop from a node-based structure looks.
+// Amortized scan and free cost included.
+// Args:
+//   0 -> scan_every
+static void BM_Epoch_Retire(benchmark::State& state) {
+    std::size_t peak = 0;
+    {
+        auto h = domain(static_cast<std::size_t>(state.range(0))).register_thread();
+        for (auto _ : state) {
+            auto g = h.pin();
+            node* n = new node{1, nullptr};
+            benchmark::DoNotOptimize(n);
+            h.retire(n);
+            if (h.pending() > peak) peak = h.pending();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["peak_pending"] = benchmark::Counter(static_cast<double>(peak), benchmark::Counter::kAvgThreads);
+}
+BENCHMARK(BM_Epoch_Retire)->Arg(16)->Arg(128)->ThreadRange(1, 32)->UseRealTime();
+
+// Baseline for the above: new + delete straight away (what you'd do without
+// concurrent readers)
+static void BM_Epoch_DeleteBaseline(benchmark::State& state) {
+    for (auto _ : state) {
+        node* n = new node{1, nullptr};
+        benchmark::DoNotOptimize(n);
+        delete n;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Epoch_DeleteBaseline)->ThreadRange(1, 32)->UseRealTime();
+
+// The O(threads) part: one try_advance() with N registered (unpinned) threads
+// Args:
+//   0 -> registered threads
+static void BM_Epoch_Scan(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    // Handles don't move, so each sits in its own heap box
+    struct registered {
+        stel::epoch_domain::thread_handle h;
+        explicit registered(stel::epoch_domain& d) : h(d.register_thread()) { }
+    };
+    stel::epoch_domain dom(n + 1);
+    std::vector<std::unique_ptr<registered>> handles;
+    for (std::size_t i = 0; i < n; ++i) handles.push_back(std::make_unique<registered>(dom));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dom.try_advance());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Epoch_Scan)->RangeMultiplier(2)->Range(1, 32);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "eventfd_queue.hpp"
+
+using clock_type = std::chrono::steady_clock;
+
+static inline std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_type::now().time_since_epoch()).count();
+}
+
+// Messages carry their send timestamp, the consumer accumulates latency.
+// The producer sends bursts with idle gaps in between, which is what
+// network threads see - and where the eventfd arming matters.
+//
+// Args:
+//   0 -> messages per iteration
+//   1 -> burst size
+//   2 -> gap between bursts (us)
+static void BM_EventfdQueue_Epoll(benchmark::State& state) {
+    const std::size_t msgs = static_cast<std::size_t>(state.range(0));
+    const std::size_t burst = static_cast<std::size_t>(state.range(1));
+    const auto gap = std::chrono::microseconds(state.range(2));
+
+    stel::eventfd_spsc_queue<std::int64_t> q(4096);
+    std::uint64_t wakeups = 0;
+    std::int64_t latency_sum = 0;
+    std::uint64_t received = 0;
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            const int ep = ::epoll_create1(0);
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = q.fd();
+            ::epoll_ctl(ep, EPOLL_CTL_ADD, q.fd(), &ev);
+
+            std::size_t got = 0;
+            while (got < msgs) {
+                epoll_event out;
+                if (::epoll_wait(ep, &out, 1, 100) <= 0) continue;
+                ++wakeups;
+                q.consume_event();
+                do {
+                    got += q.drain([&](std::int64_t ts) { latency_sum += now_ns() - ts; });
+                } while (!q.arm());
+            }
+            received += got;
+            ::close(ep);
+        });
+
+        for (std::size_t i = 0; i < msgs; ) {
+            for (std::size_t b = 0; b < burst && i < msgs; ++b, ++i) {
+                while (!q.try_push(now_ns())) { }
+            }
+            std::this_thread::sleep_for(gap);
+        }
+        consumer.join();
+    }
+
+    const double total = static_cast<double>(msgs * state.iterations());
+    // producer writes + (consumer epoll_wait + read) per wakeup - writes that land
+    // while the consumer is still awake coalesce into one wakeup
+    state.counters["syscalls/msg"] = (static_cast<double>(q.signals()) + 2.0 * static_cast<double>(wakeups)) / total;
+    state.counters["avg_latency_ns"] = static_cast<double>(latency_sum) / static_cast<double>(received);
+    state.SetItemsProcessed(static_cast<int64_t>(total));
+}
+BENCHMARK(BM_EventfdQueue_Epoll)
+    ->Args({100000, 1, 10})
+    ->Args({100000, 64, 10})
+    ->Args({100000, 1024, 10})
+    ->UseRealTime()
+    ->Iterations(3);
+
+// Baseline: consumer busy-polls the ring, no syscalls but a burned core
+static void BM_SPSC_Polling(benchmark::State& state) {
+    const std::size_t msgs = static_cast<std::size_t>(state.range(0));
+    const std::size_t burst = static_cast<std::size_t>(state.range(1));
+    const auto gap = std::chrono::microseconds(state.range(2));
+
+    lock_free_spsc_queue<std::int64_t> q(4096);
+    std::int64_t latency_sum = 0;
+    std::uint64_t received = 0;
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            std::size_t got = 0;
+            std::int64_t ts;
+            while (got < msgs) {
+                if (q.try_pop(ts)) {
+                    latency_sum += now_ns() - ts;
+                    ++got;
+                }
+            }
+            received += got;
+        });
+
+        for (std::size_t i = 0; i < msgs; ) {
+            for (std::size_t b = 0; b < burst && i < msgs; ++b, ++i) {
+                while (!q.try_push(now_ns())) { }
+            }
+            std::this_thread::sleep_for(gap);
+        }
+        consumer.join();
+    }
+
+    state.counters["syscalls/msg"] = 0;
+    state.counters["avg_latency_ns"] = static_cast<double>(latency_sum) / static_cast<double>(received);
+    state.SetItemsProcessed(static_cast<int64_t>(msgs * state.iterations()));
+}
+BENCHMARK(BM_SPSC_Polling)
+    ->Args({100000, 1, 10})
+    ->Args({100000, 64, 10})
+    ->Args({100000, 1024, 10})
+    ->UseRealTime()
+    ->Iterations(3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "affinity.hpp"
+#include "fan_in.hpp"
+#include "lock_free_mpmc_bounded.hpp"
+
+// N producers -> 1 consumer, every producer pushes `per_producer` items.
+// Consumer is pinned to cpu 0, producers to 1..N (wrapping on small boxes).
+//
+// Args:
+//   0 -> producers
+//   1 -> items per producer
+
+static constexpr std::size_t ring_capacity = 1024;
+
+// Baseline: everyone hammers the same tail_ of one MPMC queue
+static void BM_FanIn_MPMC(benchmark::State& state) {
+    const std::size_t producers = static_cast<std::size_t>(state.range(0));
+    const std::uint64_t per_producer = static_cast<std::uint64_t>(state.range(1));
+
+    for (auto _ : state) {
+        mpmc_bounded_queue<std::uint64_t> q(ring_capacity * 8);
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                stel::pin_current_thread(static_cast<unsigned>(p + 1));
+                while (!go.load(std::memory_order_acquire)) { }
+                for (std::uint64_t i = 0; i < per_producer; ++i) {
+                    while (!q.try_enqueue(i)) { }
+                }
+            });
+        }
+
+        stel::scoped_pin pin(0);
+        go.store(true, std::memory_order_release);
+        std::uint64_t got = 0, sum = 0, v;
+        while (got < producers * per_producer) {
+            if (q.try_dequeue(v)) {
+                sum += v;
+                ++got;
+            }
+        }
+        for (auto& t : threads) t.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(producers * per_producer * state.iterations()));
+}
+
+// One SPSC ring per producer, consumer drains in batches via the bitmap
+static void BM_FanIn_Drain(benchmark::State& state) {
+    const std::size_t producers = static_cast<std::size_t>(state.range(0));
+    const std::uint64_t per_producer = static_cast<std::uint64_t>(state.range(1));
+
+    for (auto _ : state) {
+        stel::fan_in_channel<std::uint64_t> ch(producers, ring_capacity);
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                auto h = ch.register_producer();
+                stel::pin_current_thread(static_cast<unsigned>(p + 1));
+                while (!go.load(std::memory_order_acquire)) { }
+                for (std::uint64_t i = 0; i < per_producer; ++i) {
+                    while (!h.try_push(i)) { }
+                }
+            });
+        }
+
+        stel::scoped_pin pin(0);
+        go.store(true, std::memory_order_release);
+        std::uint64_t got = 0, sum = 0;
+        while (got < producers * per_producer) {
+            got += ch.drain([&](std::uint64_t& v) { sum += v; });
+        }
+        for (auto& t : threads) t.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(producers * per_producer * state.iterations()));
+}
+
+// Same, but one item per call in round-robin order (fairness over batching)
+static void BM_FanIn_RoundRobin(benchmark::State& state) {
+    const std::size_t producers = static_cast<std::size_t>(state.range(0));
+    const std::uint64_t per_producer = static_cast<std::uint64_t>(state.range(1));
+
+    for (auto _ : state) {
+        stel::fan_in_channel<std::uint64_t> ch(producers, ring_capacity);
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                auto h = ch.register_producer();
+                stel::pin_current_thread(static_cast<unsigned>(p + 1));
+                while (!go.load(std::memory_order_acquire)) { }
+                for (std::uint64_t i = 0; i < per_producer; ++i) {
+                    while (!h.try_push(i)) { }
+                }
+            });
+        }
+
+        stel::scoped_pin pin(0);
+        go.store(true, std::memory_order_release);
+        std::uint64_t got = 0, sum = 0, v;
+        while (got < producers * per_producer) {
+            if (ch.try_pop(v)) {
+                sum += v;
+                ++got;
+            }
+        }
+        for (auto& t : threads) t.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(producers * per_producer * state.iterations()));
+}
+
+#define FAN_IN_ARGS \
+    ->Args({2, 200000}) \
+    ->Args({4, 100000}) \
+    ->Args({8, 50000}) \
+    ->Args({16, 25000}) \
+    ->Args({32, 12500}) \
+    ->UseRealTime() \
+    ->Unit(benchmark::kMillisecond)
+
+BENCHMARK(BM_FanIn_MPMC) FAN_IN_ARGS;
+BENCHMARK(BM_FanIn_Drain) FAN_IN_ARGS;
+BENCHMARK(BM_FanIn_RoundRobin) FAN_IN_ARGS;
+
+BENCHMARK_MAIN();
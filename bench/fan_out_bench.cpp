@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "affinity.hpp"
+#include "fan_out.hpp"
+#include "lock_free_mpmc_bounded.hpp"
+
+// 1 dispatcher -> N workers. The dispatcher is pinned to cpu 0, workers to 1..N.
+// Every item costs the worker `work` iterations of busy spinning; odd items cost
+// 4x as much, so a policy that ignores queue depth shows up in "imbalance"
+// (max items handled by one worker / mean).
+//
+// Args:
+//   0 -> workers
+//   1 -> items per iteration
+//   2 -> work per item (spin iterations)
+
+static constexpr std::size_t ring_capacity = 1024;
+
+static inline void spin_work(std::uint64_t item, std::int64_t work) {
+    const std::int64_t n = (item & 1) ? work * 4 : work;
+    for (std::int64_t i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(i);
+    }
+}
+
+static void report(benchmark::State& state, const std::vector<std::uint64_t>& per_worker, std::uint64_t items) {
+    const double mean = static_cast<double>(items) / static_cast<double>(per_worker.size());
+    const auto max = *std::max_element(per_worker.begin(), per_worker.end());
+    state.counters["imbalance"] = static_cast<double>(max) / mean;
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+}
+
+// Baseline: all workers pop from one shared ring
+static void BM_FanOut_MPMC(benchmark::State& state) {
+    const std::size_t workers = static_cast<std::size_t>(state.range(0));
+    const std::uint64_t items = static_cast<std::uint64_t>(state.range(1));
+    const std::int64_t work = state.range(2);
+    std::vector<std::uint64_t> handled(workers, 0);
+
+    for (auto _ : state) {
+        mpmc_bounded_queue<std::uint64_t> q(ring_capacity * workers);
+        std::atomic<bool> done{false};
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < workers; ++w) {
+            threads.emplace_back([&, w] {
+                stel::pin_current_thread(static_cast<unsigned>(w + 1));
+                std::uint64_t v, n = 0;
+                for (;;) {
+                    if (q.try_dequeue(v)) {
+                        spin_work(v, work);
+                        ++n;
+                    } else if (done.load(std::memory_order_acquire)) {
+                        if (!q.try_dequeue(v)) break;
+                        spin_work(v, work);
+                        ++n;
+                    }
+                }
+                handled[w] += n;
+            });
+        }
+
+        stel::scoped_pin pin(0);
+        for (std::uint64_t i = 0; i < items; ++i) {
+            while (!q.try_enqueue(i)) { }
+        }
+        done.store(true, std::memory_order_release);
+        for (auto& t : threads) t.join();
+    }
+    report(state, handled, items * state.iterations());
+}
+
+template <stel::fan_out_policy Policy>
+static void BM_FanOut_Dispatcher(benchmark::State& state) {
+    const std::size_t workers = static_cast<std::size_t>(state.range(0));
+    const std::uint64_t items = static_cast<std::uint64_t>(state.range(1));
+    const std::int64_t work = state.range(2);
+    std::vector<std::uint64_t> handled(workers, 0);
+
+    typename stel::fan_out_dispatcher<std::uint64_t>::options opt;
+    opt.policy = Policy;
+
+    for (auto _ : state) {
+        stel::fan_out_dispatcher<std::uint64_t> d(workers, ring_capacity, opt);
+        std::atomic<bool> done{false};
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < workers; ++w) {
+            threads.emplace_back([&, w] {
+                stel::pin_current_thread(static_cast<unsigned>(w + 1));
+                std::uint64_t n = 0;
+                auto consume = [&](std::uint64_t& v) { spin_work(v, work); ++n; };
+                while (!done.load(std::memory_order_acquire)) {
+                    d.drain(w, consume);
+                }
+                d.drain(w, consume, ~std::size_t(0));
+                handled[w] += n;
+            });
+        }
+
+        stel::scoped_pin pin(0);
+        for (std::uint64_t i = 0; i < items; ++i) {
+            while (!d.try_push(i, i)) { }
+        }
+        done.store(true, std::memory_order_release);
+        for (auto& t : threads) t.join();
+    }
+    report(state, handled, items * state.iterations());
+}
+
+#define FAN_OUT_ARGS \
+    ->ArgsProduct({{2, 4, 8, 16}, {200000}, {0, 200}}) \
+    ->UseRealTime() \
+    ->Unit(benchmark::kMillisecond)
+
+BENCHMARK(BM_FanOut_MPMC) FAN_OUT_ARGS;
+BENCHMARK(BM_FanOut_Dispatcher<stel::fan_out_policy::round_robin>) FAN_OUT_ARGS;
+BENCHMARK(BM_FanOut_Dispatcher<stel::fan_out_policy::least_occupied>) FAN_OUT_ARGS;
+BENCHMARK(BM_FanOut_Dispatcher<stel::fan_out_policy::key_hash>) FAN_OUT_ARGS;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+// HDR-style latency histogram: log-linear buckets with a fixed relative error.
+//
+// Values below 2^sub_bits get one bucket each. Above that every power of two is
+// split into 2^(sub_bits - 1) equal buckets, so a value is off by at most
+// 1 / 2^(sub_bits - 1) of itself (sub_bits = 7 -> under 1.6%) whatever its
+// magnitude. 64-bit values need at most (66 - sub_bits) * 2^(sub_bits - 1)
+// buckets, a few KB.
+//
+// Buckets are atomics (relaxed), so several threads may record into one
+// histogram - each record is one fetch_add on a bucket nobody else is likely
+// hitting at the same moment.
+class hdr_histogram {
+public:
+    explicit hdr_histogram(unsigned sub_bits = 7)
+        : sub_bits_(sub_bits)
+        , half_(std::uint64_t(1) << (sub_bits - 1))
+        , buckets_count_((66 - sub_bits) * half_)
+        , buckets_(std::make_unique<std::atomic<std::uint64_t>[]>(buckets_count_))
+    { }
+
+    void record(std::uint64_t v) noexcept {
+        buckets_[index_(v)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(v, std::memory_order_relaxed);
+        std::uint64_t m = max_.load(std::memory_order_relaxed);
+        while (v > m && !max_.compare_exchange_weak(m, v, std::memory_order_relaxed)) { }
+        m = min_.load(std::memory_order_relaxed);
+        while (v < m && !min_.compare_exchange_weak(m, v, std::memory_order_relaxed)) { }
+    }
+
+    // Smallest recorded value v such that at least p percent are <= v
+    // (reported as the upper edge of its bucket, but never above max()).
+    std::uint64_t percentile(double p) const noexcept {
+        const std::uint64_t n = count();
+        if (n == 0) return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(n) + 0.5);
+        if (rank == 0) rank = 1;
+        if (rank > n) rank = n;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets_count_; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                const std::uint64_t hi = upper_(i);
+                return hi < max() ? hi : max();
+            }
+        }
+        return max();
+    }
+
+    std::uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    std::uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+    std::uint64_t min() const noexcept { return count() ? min_.load(std::memory_order_relaxed) : 0; }
+    double mean() const noexcept {
+        const std::uint64_t n = count();
+        return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+    }
+
+    void reset() noexcept {
+        for (std::size_t i = 0; i < buckets_count_; ++i) buckets_[i].store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    }
+
+    // p50/p99/p99.9/p99.99/max as benchmark counters, with a unit suffix
+    void report(benchmark::State& state, const char* unit = "ns") const {
+        auto name = [unit](const char* what) { return std::string(what) + "_" + unit; };
+        state.counters[name("p50")] = static_cast<double>(percentile(50.0));
+        state.counters[name("p99")] = static_cast<double>(percentile(99.0));
+        state.counters[name("p99.9")] = static_cast<double>(percentile(99.9));
+        state.counters[name("p99.99")] = static_cast<double>(percentile(99.99));
+        state.counters[name("max")] = static_cast<double>(max());
+        state.counters[name("mean")] = mean();
+    }
+
+private:
+    std::size_t index_(std::uint64_t v) const noexcept {
+        if (v < 2 * half_) return static_cast<std::size_t>(v);
+        const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - sub_bits_;
+        // v >> shift lands in [half_, 2 * half_)
+        return static_cast<std::size_t>(shift * half_ + (v >> shift));
+    }
+
+    std::uint64_t upper_(std::size_t idx) const noexcept {
+        if (idx < 2 * half_) return idx;
+        const unsigned shift = static_cast<unsigned>(idx / half_ - 1);
+        const std::uint64_t q = idx - shift * half_;
+        return ((q + 1) << shift) - 1;
+    }
+
+    const unsigned sub_bits_;
+    const std::uint64_t half_;
+    const std::size_t buckets_count_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+    std::atomic<std::uint64_t> min_{std::numeric_limits<std::uint64_t>::max()};
+};
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <thread>
+#include <variant>
+
+#include "hetero_spsc.hpp"
+#include "lock_free_spsc.hpp"
+
+// A market-data style mix: mostly tiny messages with the occasional big one.
+// Every 16th message is a `snapshot`, the rest are `tick`s and `order`s.
+struct tick     { std::uint64_t ts; };                              //   8 bytes
+struct order    { std::uint64_t id; double px; std::uint32_t qty; }; //  24 bytes
+struct snapshot { std::uint64_t ts; double levels[30]; };            // 248 bytes
+
+using message = std::variant<tick, order, snapshot>;
+
+// Same bytes of ring memory for both queues
+static constexpr std::size_t ring_bytes = 1 << 18;
+
+struct sink {
+    std::uint64_t sum = 0;
+    void operator()(const tick& t) { sum += t.ts; }
+    void operator()(const order& o) { sum += o.qty; }
+    void operator()(const snapshot& s) { sum += s.ts; }
+};
+
+template <typename Push>
+static void produce(std::uint64_t count, Push&& push) {
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (i % 16 == 15) {
+            snapshot s{};
+            s.ts = i;
+            push(s);
+        } else if (i & 1) {
+            push(order{i, 1.0, 1});
+        } else {
+            push(tick{i});
+        }
+    }
+}
+
+// Args:
+//   0 -> messages per iteration
+static void BM_Variant_SPSC(benchmark::State& state) {
+    const std::uint64_t count = static_cast<std::uint64_t>(state.range(0));
+    lock_free_spsc_queue<message> q(ring_bytes / sizeof(message));
+    sink s;
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            std::uint64_t got = 0;
+            while (got < count) {
+                got += q.pop_bulk([&](message& m) { std::visit(s, m); }, 64);
+            }
+        });
+        produce(count, [&](auto m) { while (!q.try_push(message(m))) { } });
+        consumer.join();
+    }
+    benchmark::DoNotOptimize(s.sum);
+    state.counters["slot_bytes"] = sizeof(message);
+    state.counters["ring_msgs"] = static_cast<double>(q.capacity());
+    state.SetItemsProcessed(static_cast<int64_t>(count * state.iterations()));
+}
+BENCHMARK(BM_Variant_SPSC)->Arg(1 << 20)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_Hetero_SPSC(benchmark::State& state) {
+    const std::uint64_t count = static_cast<std::uint64_t>(state.range(0));
+    using ring_type = stel::hetero_spsc_ring<tick, order, snapshot>;
+    ring_type r(ring_bytes);
+    sink s;
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            std::uint64_t got = 0;
+            while (got < count) {
+                got += r.consume_bulk(s, 64);
+            }
+        });
+        produce(count, [&](auto m) { while (!r.try_push(m)) { } });
+        consumer.join();
+    }
+    benchmark::DoNotOptimize(s.sum);
+    // Average record size for this mix
+    const double avg = (8.0 * ring_type::record_size<tick>() + 7.0 * ring_type::record_size<order>() +
+                        1.0 * ring_type::record_size<snapshot>()) / 16.0;
+    state.counters["slot_bytes"] = avg;
+    state.counters["ring_msgs"] = static_cast<double>(ring_bytes) / avg;
+    state.SetItemsProcessed(static_cast<int64_t>(count * state.iterations()));
+}
+BENCHMARK(BM_Hetero_SPSC)->Arg(1 << 20)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,152 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "affinity.hpp"
+#include "backoff.hpp"
+#include "bounded_mpmc_pool.hpp"
+#include "hdr_histogram.hpp"
+#include "lock_free_mpmc_bounded.hpp"
+#include "lock_free_spsc.hpp"
+#include "thread_pool.hpp"
+#include "thread_safe_queue.hpp"
+
+// Round-trip latency: one iteration = the pinger (cpu 0) sends its send timestamp,
+// the echo side (cpu 1) sends it straight back, the pinger records now - timestamp.
+// One message in flight at a time, so this is pure hand-off latency, no queueing.
+//
+// Reports p50 / p99 / p99.9 / p99.99 / max in ns from an HDR-style histogram.
+// Time is steady_clock (vDSO, ~20ns to read), paid once per round trip and the
+// same for every queue. On boxes with fewer than two CPUs pinning wraps and the
+// numbers mostly measure the scheduler.
+
+using clock_type = std::chrono::steady_clock;
+
+static inline std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_type::now().time_since_epoch()).count());
+}
+
+static constexpr std::size_t ring_capacity = 1024;
+
+// Ping-pong over a pair of rings. Push/Pop adapt the queue API.
+template <typename Queue, typename Push, typename Pop>
+static void ping_pong(benchmark::State& state, Push push, Pop pop) {
+    Queue ping(ring_capacity);
+    Queue pong(ring_capacity);
+    std::atomic<bool> stop{false};
+    hdr_histogram hist;
+
+    std::thread echo([&] {
+        stel::pin_current_thread(1);
+        std::uint64_t ts;
+        stel::backoff b;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (pop(ping, ts)) {
+                while (!push(pong, ts)) { }
+                b.reset();
+            } else {
+                b.pause();
+            }
+        }
+    });
+
+    stel::scoped_pin pin(0);
+    for (auto _ : state) {
+        const std::uint64_t t0 = now_ns();
+        while (!push(ping, t0)) { }
+        std::uint64_t back;
+        stel::backoff b;
+        while (!pop(pong, back)) b.pause();
+        hist.record(now_ns() - back);
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    echo.join();
+    hist.report(state);
+}
+
+static void BM_Latency_SPSC(benchmark::State& state) {
+    using Q = lock_free_spsc_queue<std::uint64_t>;
+    ping_pong<Q>(state,
+        [](Q& q, std::uint64_t v) { return q.try_push(v); },
+        [](Q& q, std::uint64_t& v) { return q.try_pop(v); });
+}
+BENCHMARK(BM_Latency_SPSC)->Iterations(200000)->UseRealTime();
+
+static void BM_Latency_MPMC(benchmark::State& state) {
+    using Q = mpmc_bounded_queue<std::uint64_t>;
+    ping_pong<Q>(state,
+        [](Q& q, std::uint64_t v) { return q.try_enqueue(v); },
+        [](Q& q, std::uint64_t& v) { return q.try_dequeue(v); });
+}
+BENCHMARK(BM_Latency_MPMC)->Iterations(200000)->UseRealTime();
+
+// Blocking queue: both sides sleep in wait_and_pop(), so this includes the
+// condition variable wakeup - which is how it is used
+static void BM_Latency_ThreadSafeQueue(benchmark::State& state) {
+    stel::thread_safe_queue<std::uint64_t> ping;
+    stel::thread_safe_queue<std::uint64_t> pong;
+    hdr_histogram hist;
+
+    std::thread echo([&] {
+        stel::pin_current_thread(1);
+        std::uint64_t ts;
+        while (ping.wait_and_pop(ts)) {
+            pong.push(ts);
+        }
+    });
+
+    stel::scoped_pin pin(0);
+    for (auto _ : state) {
+        ping.push(now_ns());
+        std::uint64_t back;
+        if (!pong.wait_and_pop(back)) break;
+        hist.record(now_ns() - back);
+    }
+
+    ping.shutdown();
+    echo.join();
+    hist.report(state);
+}
+BENCHMARK(BM_Latency_ThreadSafeQueue)->Iterations(50000)->UseRealTime();
+
+// Pools: submit a task that hands the timestamp back through an atomic. Measures
+// submit -> a worker picks it up -> the submitter sees it done. The worker may be
+// asleep between tasks (that's what the pool does when idle), so this includes
+// the wake-up path.
+template <typename Pool>
+static void pool_round_trip(benchmark::State& state, Pool& pool) {
+    std::atomic<std::uint64_t> done{0};
+    hdr_histogram hist;
+
+    stel::scoped_pin pin(0);
+    for (auto _ : state) {
+        done.store(0, std::memory_order_relaxed);
+        const std::uint64_t t0 = now_ns();
+        pool.submit([&done, t0] { done.store(t0, std::memory_order_release); });
+        stel::backoff b;
+        std::uint64_t back;
+        while ((back = done.load(std::memory_order_acquire)) == 0) b.pause();
+        hist.record(now_ns() - back);
+    }
+    hist.report(state);
+}
+
+// Args:
+//   0 -> workers
+static void BM_Latency_BoundedPool(benchmark::State& state) {
+    stel::bounded_mpmc_pool pool(static_cast<std::size_t>(state.range(0)), ring_capacity);
+    pool_round_trip(state, pool);
+}
+BENCHMARK(BM_Latency_BoundedPool)->Arg(1)->Arg(4)->Iterations(50000)->UseRealTime();
+
+static void BM_Latency_MutexPool(benchmark::State& state) {
+    stel::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+    pool_round_trip(state, pool);
+}
+BENCHMARK(BM_Latency_MutexPool)->Arg(1)->Arg(4)->Iterations(50000)->UseRealTime();
+
+BENCHMARK_MAIN();
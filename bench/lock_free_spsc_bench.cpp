@@ -4,31 +4,45 @@
 #include <thread>
 #include <atomic>
 
-#include "lock_free_spsc.hpp"   
-
-// Simple 2-thread spin barrier for start sync
+#include "backoff.hpp"
+#include "bqueue_spsc.hpp"
+#include "lock_free_spsc.hpp"
+#include "perf_counters.hpp"
+
+// Simple 2-thread spin barrier for start sync.
+// Waiters watch the generation, not the counter: a fast thread may already have
+// arrived at the next barrier (counter back to 1) before a slow one looks.
 struct SpinBarrier {
     std::atomic<int> arrived{0};
+    std::atomic<unsigned> generation{0};
     void arrive_and_wait(int total) {
+        const unsigned gen = generation.load(std::memory_order_acquire);
         if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == total) {
-            // last thread resets to 0 to release the other
-            arrived.store(0, std::memory_order_release);
+            // last thread resets the count and releases the others
+            arrived.store(0, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            generation.notify_all();
             return;
         }
-        // spin until the last thread resets the counter
-        while (arrived.load(std::memory_order_acquire) != 0) { benchmark::DoNotOptimize(arrived); }
+        // spin (then park) until the last thread bumps the generation
+        stel::backoff b;
+        while (generation.load(std::memory_order_acquire) == gen) {
+            b.wait(generation, gen);
+        }
     }
 };
 
-static void BM_SPSC_Throughput(benchmark::State& state) {
+// Same harness for every SPSC queue type, so the numbers compare head to head
+template <typename Queue>
+static void spsc_throughput(benchmark::State& state) {
     const std::size_t items     = static_cast<std::size_t>(state.range(0));
     const std::size_t capacity  = static_cast<std::size_t>(state.range(1));
 
-    static std::unique_ptr<lock_free_spsc_queue<std::uint64_t>> queue;
+    static std::unique_ptr<Queue> queue;
     static SpinBarrier start_bar;
 
     if (state.thread_index() == 0) {
-        queue = std::make_unique<lock_free_spsc_queue<std::uint64_t>>(capacity);
+        queue = std::make_unique<Queue>(capacity);
     }
 
     //state.counters["capacity"] = static_cast<double>(capacity);
@@ -52,6 +66,10 @@ static void BM_SPSC_Throughput(benchmark::State& state) {
 							   benchmark::Counter::kIsIterationInvariantRate);
 	}
 
+    // Each side counts its own thread; summed, the counters are per item transferred
+    perf_counters perf(/*inherit=*/false);
+    perf.start();
+
     for (auto _ : state) {
         state.PauseTiming();
         std::atomic_thread_fence(std::memory_order_seq_cst);
@@ -63,18 +81,20 @@ static void BM_SPSC_Throughput(benchmark::State& state) {
             // Producer
             for (std::size_t i = 0; i < items; ++i) {
                 std::uint64_t v = static_cast<std::uint64_t>(i);
-                // Busy-wait until space is available
+                // Spin (with backoff) until space is available
+                stel::backoff b;
                 while (!queue->try_push(v)) {
-                    benchmark::DoNotOptimize(v);
+                    b.pause();
                 }
             }
         } else {
             // Consumer
             std::uint64_t out;
             for (std::size_t i = 0; i < items; ++i) {
-                // Busy-wait until an item arrives
+                // Spin (with backoff) until an item arrives
+                stel::backoff b;
                 while (!queue->try_pop(out)) {
-                    benchmark::DoNotOptimize(out);
+                    b.pause();
                 }
                 benchmark::DoNotOptimize(out);
             }
@@ -84,6 +104,9 @@ static void BM_SPSC_Throughput(benchmark::State& state) {
         start_bar.arrive_and_wait(/*total=*/2);
     }
 
+    perf.stop();
+    perf.report(state, static_cast<double>(items * state.iterations()));
+
     if (state.thread_index() == 0) {
         state.SetItemsProcessed(state.items_processed() + static_cast<int64_t>(items * state.iterations()));
         state.counters["items_per_sec"] = benchmark::Counter(
@@ -92,6 +115,10 @@ static void BM_SPSC_Throughput(benchmark::State& state) {
     }
 }
 
+static void BM_SPSC_Throughput(benchmark::State& state) {
+    spsc_throughput<lock_free_spsc_queue<std::uint64_t>>(state);
+}
+
 BENCHMARK(BM_SPSC_Throughput)
     ->Args({1 << 20, 1024})      // 1M items, cap=1024
     ->Args({1 << 20, 4096})
@@ -101,4 +128,17 @@ BENCHMARK(BM_SPSC_Throughput)
 	//->Repetitions(5)->ReportAggregatesOnly(true)
     ->Threads(2);
 
+// B-Queue: no shared head/tail, both sides probe slot flags a batch ahead
+static void BM_BQueue_Throughput(benchmark::State& state) {
+    spsc_throughput<bqueue_spsc_queue<std::uint64_t>>(state);
+}
+
+BENCHMARK(BM_BQueue_Throughput)
+    ->Args({1 << 20, 1024})
+    ->Args({1 << 20, 4096})
+    ->Args({1 << 20, 1 << 15})
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Threads(2);
+
 BENCHMARK_MAIN();
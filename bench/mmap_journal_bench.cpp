@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "mmap_journal.hpp"
+
+static std::string fresh_dir() {
+    char name[] = "/tmp/journal_bench_XXXXXX";
+    return ::mkdtemp(name);
+}
+
+static void remove_dir(const std::string& dir) {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// --------------------------------------------------
+// Append latency: cost of one append on the hot thread,
+// rollovers included. Iterations are capped so a run writes
+// at most ~130MB into /tmp (often tmpfs, i.e. RAM).
+// Args:
+//   0 -> payload bytes
+// --------------------------------------------------
+static void BM_Journal_Append(benchmark::State& state) {
+    const std::size_t len = static_cast<std::size_t>(state.range(0));
+    const std::string dir = fresh_dir();
+    std::vector<char> msg(len, 'j');
+    {
+        stel::journal_appender app(dir, 64 << 20);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(app.append(msg.data(), msg.size()));
+        }
+    }
+    remove_dir(dir);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(len * state.iterations()));
+}
+BENCHMARK(BM_Journal_Append)->Arg(32)->Arg(256)->Arg(2048)->Iterations(1 << 16);
+
+// --------------------------------------------------
+// Tailer throughput while the appender is running
+// Args:
+//   0 -> payload bytes
+//   1 -> entries per iteration
+// --------------------------------------------------
+static void BM_Journal_Tail(benchmark::State& state) {
+    const std::size_t len = static_cast<std::size_t>(state.range(0));
+    const std::uint64_t entries = static_cast<std::uint64_t>(state.range(1));
+    std::vector<char> msg(len, 't');
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        const std::string dir = fresh_dir();
+        stel::journal_appender app(dir, 64 << 20);
+        state.ResumeTiming();
+
+        std::thread reader([&] {
+            stel::journal_tailer tail(dir);
+            std::uint64_t got = 0;
+            std::uint64_t bytes = 0;
+            while (got < entries) {
+                if (tail.try_read([&](std::uint64_t, const std::byte*, std::size_t n) { bytes += n; })) {
+                    ++got;
+                }
+            }
+            benchmark::DoNotOptimize(bytes);
+        });
+        for (std::uint64_t i = 0; i < entries; ++i) {
+            app.append(msg.data(), msg.size());
+        }
+        reader.join();
+
+        state.PauseTiming();
+        remove_dir(dir);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(entries * state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(entries * len * state.iterations()));
+}
+BENCHMARK(BM_Journal_Tail)
+    ->Args({64, 1 << 20})
+    ->Args({512, 1 << 18})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
+BENCHMARK_MAIN();
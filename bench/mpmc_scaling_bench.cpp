@@ -0,0 +1,205 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "affinity.hpp"
+#include "backoff.hpp"
+#include "lock_free_mpmc_bounded.hpp"
+#include "perf_counters.hpp"
+
+// mpmc_bounded_queue on its own, no pool around it: P producers and C consumers
+// hammer one queue until `items` have gone through.
+//
+// Producers take work from a shared budget in chunks, so nobody is told up front
+// how much to push - a producer that keeps losing the tail_ CAS simply ends up
+// with fewer items. Consumers pop until the producers are done and the queue is
+// empty. The per-thread counts then say how fair the queue is under contention:
+//
+//	fair_prod / fair_cons: Jain's index over the per-thread counts,
+//	                       1 = everyone did the same, 1/N = one thread did it all
+//	minmax_prod / minmax_cons: least busy thread / busiest thread
+//
+// Time is measured from releasing the threads to the last one finishing (thread
+// start-up excluded). ns/op is wall time per item through the queue. Hardware
+// counters (perf_counters.hpp) cover every thread, start-up included.
+//
+// Args:
+//   0 -> producers
+//   1 -> consumers
+//   2 -> capacity
+//   3 -> payload bytes (8, 64, 256)
+//   4 -> 1 = pin threads (producers on cpus 0.., consumers after them), 0 = let the OS place them
+
+static constexpr std::uint64_t items = 1 << 20;
+static constexpr std::uint64_t chunk = 256;
+
+template <std::size_t Bytes>
+struct payload {
+    std::uint64_t v;
+    unsigned char pad[Bytes - sizeof(std::uint64_t)];
+};
+
+template <>
+struct payload<sizeof(std::uint64_t)> {
+    std::uint64_t v;
+};
+
+struct fairness {
+    double jain;
+    double minmax;
+};
+
+static fairness fairness_of(const std::vector<std::uint64_t>& counts) {
+    double sum = 0, sq = 0;
+    for (std::uint64_t c : counts) {
+        sum += static_cast<double>(c);
+        sq += static_cast<double>(c) * static_cast<double>(c);
+    }
+    const auto [lo, hi] = std::minmax_element(counts.begin(), counts.end());
+    return fairness{
+        sq == 0 ? 1.0 : sum * sum / (static_cast<double>(counts.size()) * sq),
+        *hi == 0 ? 1.0 : static_cast<double>(*lo) / static_cast<double>(*hi)
+    };
+}
+
+template <std::size_t Bytes>
+static void mpmc_matrix(benchmark::State& state) {
+    using item = payload<Bytes>;
+    const std::size_t producers = static_cast<std::size_t>(state.range(0));
+    const std::size_t consumers = static_cast<std::size_t>(state.range(1));
+    const std::size_t capacity  = static_cast<std::size_t>(state.range(2));
+    const bool pinned           = state.range(4) != 0;
+
+    double total_ns = 0;
+    fairness prod_fair{0, 0}, cons_fair{0, 0};
+
+    // Inherited by the producer/consumer threads, which are joined every iteration
+    perf_counters perf;
+    perf.start();
+
+    for (auto _ : state) {
+        mpmc_bounded_queue<item> q(capacity);
+        std::atomic<std::uint64_t> budget{items};
+        std::atomic<std::size_t> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<bool> producers_done{false};
+        std::vector<std::uint64_t> pushed(producers), popped(consumers);
+        std::vector<std::thread> prod, cons;
+
+        for (std::size_t p = 0; p < producers; ++p) {
+            prod.emplace_back([&, p] {
+                if (pinned) stel::pin_current_thread(static_cast<unsigned>(p));
+                ready.fetch_add(1, std::memory_order_release);
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                std::uint64_t n = 0;
+                item it{};
+                for (;;) {
+                    const std::uint64_t left = budget.fetch_sub(chunk, std::memory_order_relaxed);
+                    if (left == 0 || left > items) break; // budget used up (or wrapped past 0)
+                    const std::uint64_t take = std::min(left, chunk);
+                    for (std::uint64_t i = 0; i < take; ++i) {
+                        it.v = n + i;
+                        stel::backoff b;
+                        while (!q.try_enqueue(it)) b.pause();
+                    }
+                    n += take;
+                }
+                pushed[p] = n;
+            });
+        }
+        for (std::size_t c = 0; c < consumers; ++c) {
+            cons.emplace_back([&, c] {
+                if (pinned) stel::pin_current_thread(static_cast<unsigned>(producers + c));
+                ready.fetch_add(1, std::memory_order_release);
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                std::uint64_t n = 0, sum = 0;
+                item it;
+                stel::backoff b;
+                for (;;) {
+                    if (q.try_dequeue(it)) {
+                        sum += it.v;
+                        ++n;
+                        b.reset();
+                    } else if (producers_done.load(std::memory_order_acquire)) {
+                        // every push has completed, so a failed pop now means empty
+                        if (!q.try_dequeue(it)) break;
+                        sum += it.v;
+                        ++n;
+                    } else {
+                        b.pause();
+                    }
+                }
+                benchmark::DoNotOptimize(sum);
+                popped[c] = n;
+            });
+        }
+
+        while (ready.load(std::memory_order_acquire) != producers + consumers) std::this_thread::yield();
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& t : prod) t.join();
+        producers_done.store(true, std::memory_order_release);
+        for (auto& t : cons) t.join();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        state.SetIterationTime(secs);
+        total_ns += secs * 1e9;
+        prod_fair = fairness_of(pushed);
+        cons_fair = fairness_of(popped);
+    }
+
+    perf.stop();
+    perf.report(state, static_cast<double>(items * state.iterations()));
+
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(items * Bytes * state.iterations()));
+    state.counters["ns/op"] = total_ns / static_cast<double>(items * state.iterations());
+    // last iteration's spread - averaging Jain's index over runs would hide a bad one
+    state.counters["fair_prod"] = prod_fair.jain;
+    state.counters["fair_cons"] = cons_fair.jain;
+    state.counters["minmax_prod"] = prod_fair.minmax;
+    state.counters["minmax_cons"] = cons_fair.minmax;
+}
+
+static void BM_MPMC_Matrix(benchmark::State& state) {
+    switch (state.range(3)) {
+    case 8:   mpmc_matrix<8>(state); break;
+    case 64:  mpmc_matrix<64>(state); break;
+    case 256: mpmc_matrix<256>(state); break;
+    default:  state.SkipWithError("payload must be 8, 64 or 256"); break;
+    }
+}
+
+// Full producers x consumers grid at the default shape (cap 1024, 8B), pinned and
+// unpinned; then capacity x payload on the diagonal, where most regressions show.
+static void matrix_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"prod", "cons", "cap", "bytes", "pin"});
+    const int threads[] = {1, 2, 4, 8, 16, 32};
+    for (int pin : {1, 0}) {
+        for (int p : threads) {
+            for (int c : threads) {
+                b->Args({p, c, 1024, 8, pin});
+            }
+        }
+    }
+    for (int n : {1, 4, 16}) {
+        for (int cap : {64, 1024, 1 << 16}) {
+            for (int bytes : {8, 64, 256}) {
+                if (cap == 1024 && bytes == 8) continue; // already in the grid
+                b->Args({n, n, cap, bytes, 1});
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_MPMC_Matrix)
+    ->Apply(matrix_args)
+    ->Iterations(3)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
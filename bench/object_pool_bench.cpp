@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+
+#include "object_pool.hpp"
+
+// A typical fixed-size message
+struct message {
+    std::uint64_t id;
+    std::uint64_t ts;
+    std::uint32_t type;
+    std::uint32_t len;
+    char payload[40];
+};
+
+// Each iteration allocates a burst of messages and frees them again, which is
+// the shape of the traffic (a handful in flight per thread at any time).
+static constexpr std::size_t burst = 32;
+
+// One pool per benchmark run, created and destroyed outside the threaded region
+// so no thread can see it half built or after it's gone
+static std::unique_ptr<stel::object_pool<message>> pool;
+
+static void make_pool(const benchmark::State&) {
+    pool = std::make_unique<stel::object_pool<message>>(1 << 16);
+}
+
+static void drop_pool(const benchmark::State&) {
+    pool.reset();
+}
+
+static void BM_ObjectPool_Cache(benchmark::State& state) {
+    // Flushes into the pool on scope exit, which is before drop_pool() runs
+    std::optional<stel::object_pool<message>::cache> cache;
+    std::array<message*, burst> held{};
+    for (auto _ : state) {
+        if (!cache) cache.emplace(*pool);
+        for (std::size_t i = 0; i < burst; ++i) {
+            held[i] = cache->acquire();
+            benchmark::DoNotOptimize(held[i]);
+        }
+        for (std::size_t i = 0; i < burst; ++i) {
+            cache->release(held[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_ObjectPool_Cache)->ThreadRange(1, 8)->UseRealTime()->Setup(make_pool)->Teardown(drop_pool);
+
+// Same pool without the magazine: every call hits the shared freelist
+static void BM_ObjectPool_Direct(benchmark::State& state) {
+    std::array<message*, burst> held{};
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < burst; ++i) {
+            held[i] = pool->acquire();
+            benchmark::DoNotOptimize(held[i]);
+        }
+        for (std::size_t i = 0; i < burst; ++i) {
+            pool->release(held[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_ObjectPool_Direct)->ThreadRange(1, 8)->UseRealTime()->Setup(make_pool)->Teardown(drop_pool);
+
+static void BM_Malloc(benchmark::State& state) {
+    std::array<void*, burst> held{};
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < burst; ++i) {
+            held[i] = std::malloc(sizeof(message));
+            benchmark::DoNotOptimize(held[i]);
+        }
+        for (std::size_t i = 0; i < burst; ++i) {
+            std::free(held[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_Malloc)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_NewDelete(benchmark::State& state) {
+    std::array<message*, burst> held{};
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < burst; ++i) {
+            held[i] = new message();
+            benchmark::DoNotOptimize(held[i]);
+        }
+        for (std::size_t i = 0; i < burst; ++i) {
+            delete held[i];
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_NewDelete)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
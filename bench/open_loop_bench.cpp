@@ -0,0 +1,151 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <latch>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "backoff.hpp"
+#include "bounded_mpmc_pool.hpp"
+#include "hdr_histogram.hpp"
+#include "thread_pool.hpp"
+
+// Open-loop load against the pools: tasks arrive on a fixed schedule whatever the
+// pool is doing, like requests from independent clients would.
+//
+// BM_BoundedPool_Submit in thread_pools_bench is closed-loop - the submitter only
+// goes as fast as the pool lets it, so when the pool stalls the submitter stalls
+// too and the requests that would have queued up behind the stall are never sent
+// (coordinated omission). Here every task has an intended start time taken from
+// the schedule, and its latency is completion - intended start. If the submitter
+// falls behind (or, for bounded_mpmc_pool, ends up running a task itself because
+// the queue is full) the following tasks are still measured from when they
+// should have been sent, so the queueing delay shows up.
+//
+// Sweeping the offered rate gives the latency-vs-throughput curve: flat until the
+// pool saturates, then p99 goes up sharply while achieved/s stops following
+// offered/s.
+//
+// Args:
+//   0 -> offered load (tasks/s)
+//   1 -> arrivals: 0 = constant spacing, 1 = Poisson (exponential gaps)
+//   2 -> per-task work (ns)
+//   3 -> workers
+
+using clock_type = std::chrono::steady_clock;
+
+static constexpr std::size_t tasks_per_iter = 20000;
+static constexpr std::size_t queue_capacity = 1024;
+
+static inline void do_work_ns(std::uint64_t ns) {
+    if (ns == 0) return;
+    const auto start = clock_type::now();
+    while (clock_type::now() - start < std::chrono::nanoseconds(ns)) {
+        benchmark::DoNotOptimize(ns);
+    }
+}
+
+// Intended start offsets in ns from the beginning of the run
+static std::vector<std::uint64_t> schedule(double rate, bool poisson, std::size_t n) {
+    std::vector<std::uint64_t> at(n);
+    std::mt19937_64 rng(42);
+    std::exponential_distribution<double> gap(rate);
+    double t = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        at[i] = static_cast<std::uint64_t>(t * 1e9);
+        t += poisson ? gap(rng) : 1.0 / rate;
+    }
+    return at;
+}
+
+template <typename Pool>
+static void open_loop(benchmark::State& state, Pool& pool) {
+    const double rate        = static_cast<double>(state.range(0));
+    const bool poisson       = state.range(1) != 0;
+    const std::uint64_t work = static_cast<std::uint64_t>(state.range(2));
+
+    const std::vector<std::uint64_t> at = schedule(rate, poisson, tasks_per_iter);
+    hdr_histogram hist;
+    double busy_secs = 0;
+    std::uint64_t late = 0;
+
+    for (auto _ : state) {
+        std::latch done(static_cast<std::ptrdiff_t>(tasks_per_iter));
+        std::atomic<std::int64_t> last_done{0};
+        const auto start = clock_type::now();
+
+        for (std::size_t i = 0; i < tasks_per_iter; ++i) {
+            const auto intended = start + std::chrono::nanoseconds(at[i]);
+            auto now = clock_type::now();
+            if (now < intended) {
+                // Sleep through long gaps, spin the last stretch - sleep wakes up late
+                if (intended - now > std::chrono::microseconds(100)) {
+                    std::this_thread::sleep_until(intended - std::chrono::microseconds(50));
+                }
+                while (clock_type::now() < intended) stel::cpu_relax();
+            } else if (now - intended > std::chrono::microseconds(10)) {
+                ++late;
+            }
+
+            pool.submit([&, intended, work] {
+                do_work_ns(work);
+                const auto end = clock_type::now();
+                hist.record(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - intended).count()));
+                const std::int64_t e = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+                std::int64_t m = last_done.load(std::memory_order_relaxed);
+                while (e > m && !last_done.compare_exchange_weak(m, e, std::memory_order_relaxed)) { }
+                done.count_down();
+            });
+        }
+        done.wait();
+        busy_secs += static_cast<double>(last_done.load(std::memory_order_relaxed)) * 1e-9;
+    }
+
+    const double completed = static_cast<double>(tasks_per_iter * state.iterations());
+    state.SetItemsProcessed(static_cast<int64_t>(completed));
+    state.counters["offered/s"] = rate;
+    state.counters["achieved/s"] = busy_secs > 0 ? completed / busy_secs : 0;
+    // Submissions more than 10us behind schedule - the generator itself couldn't keep up
+    state.counters["late"] = static_cast<double>(late) / completed;
+    hist.report(state);
+}
+
+static void BM_OpenLoop_BoundedPool(benchmark::State& state) {
+    stel::bounded_mpmc_pool pool(static_cast<std::size_t>(state.range(3)), queue_capacity);
+    open_loop(state, pool);
+    pool.drain();
+}
+
+static void BM_OpenLoop_MutexPool(benchmark::State& state) {
+    stel::thread_pool pool(static_cast<std::size_t>(state.range(3)));
+    open_loop(state, pool);
+    pool.drain();
+}
+
+// Offered load sweep at 500ns per task on 4 workers (saturates near 8M/s in
+// theory, much earlier in practice), constant and Poisson arrivals
+static void sweep_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"rate", "poisson", "work_ns", "workers"});
+    for (int poisson : {0, 1}) {
+        for (int rate : {50000, 100000, 200000, 400000, 800000, 1600000, 3200000}) {
+            b->Args({rate, poisson, 500, 4});
+        }
+    }
+}
+
+BENCHMARK(BM_OpenLoop_BoundedPool)
+    ->Apply(sweep_args)
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_OpenLoop_MutexPool)
+    ->Apply(sweep_args)
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
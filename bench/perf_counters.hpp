@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters for a benchmark, via perf_event_open(2).
+//
+//	perf_counters pc;              // opens, counters start disabled
+//	pc.start();
+//	for (auto _ : state) { ... }
+//	pc.stop();
+//	pc.report(state, items);       // cycles/op, instr/op, L1D-miss/op, ... as counters
+//
+// Counted: cycles, instructions, L1D read misses, LLC misses (the generic
+// "cache-misses" event, last level on Intel and AMD) and, if STEL_PERF_HITM is set,
+// one raw event for cache-to-cache transfers. There is no generic event for those,
+// so it has to be given per microarchitecture as a raw config (see `perf list
+// --details` or the vendor's event tables), e.g. on Intel Skylake and later
+//	STEL_PERF_HITM=0x04d2    (MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM)
+//
+// Scope: the calling thread, plus every thread it creates *after* construction
+// when inherit is true (children's counts are folded in when they exit, so join
+// them before report()). Threads created by Google Benchmark (->Threads(n)) each
+// open their own; the counters are summed across them like any other.
+//
+// Only user space is counted, which is what perf_event_paranoid = 2 (the usual
+// default) allows. Events that fail to open (no PMU in a VM, paranoid = 3, seccomp)
+// are left out of the report, and if none opened the benchmark gets a label
+// saying so - it still runs.
+class perf_counters {
+public:
+    explicit perf_counters(bool inherit = true) {
+#if defined(__linux__)
+        open_(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, inherit);
+        open_(instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, inherit);
+        open_(l1d_misses, PERF_TYPE_HW_CACHE,
+              PERF_COUNT_HW_CACHE_L1D
+              | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+              | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), inherit);
+        open_(llc_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, inherit);
+        if (const char* raw = std::getenv("STEL_PERF_HITM")) {
+            open_(hitm, PERF_TYPE_RAW, std::strtoull(raw, nullptr, 0), inherit);
+        }
+#else
+        (void)inherit;
+#endif
+    }
+
+    ~perf_counters() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator =(const perf_counters&) = delete;
+
+    bool available() const noexcept {
+        for (int fd : fds_) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+
+#if defined(__linux__)
+    void start() noexcept { ioctl_all_(PERF_EVENT_IOC_ENABLE); }
+    void stop() noexcept { ioctl_all_(PERF_EVENT_IOC_DISABLE); }
+#else
+    void start() noexcept { }
+    void stop() noexcept { }
+#endif
+
+    // Sets <event>/op for every open event, plus IPC. `ops` is what this thread's
+    // share of the work counts as - with ->Threads(n) pass each thread's own ops
+    // and the summed counters come out per op overall.
+    void report(benchmark::State& state, double ops) const {
+        if (!available()) {
+            state.SetLabel("perf counters unavailable");
+            return;
+        }
+        static const char* const names[count] = {
+            "cycles/op", "instr/op", "L1D-miss/op", "LLC-miss/op", "HITM/op"
+        };
+        std::uint64_t v[count];
+        for (int e = 0; e < count; ++e) {
+            v[e] = read_(e);
+            if (fds_[e] >= 0 && ops > 0) {
+                state.counters[names[e]] = static_cast<double>(v[e]) / ops;
+            }
+        }
+        if (fds_[cycles] >= 0 && fds_[instructions] >= 0 && v[cycles] != 0) {
+            state.counters["IPC"] = benchmark::Counter(
+                static_cast<double>(v[instructions]) / static_cast<double>(v[cycles]),
+                benchmark::Counter::kAvgThreads);
+        }
+    }
+
+private:
+    enum event { cycles, instructions, l1d_misses, llc_misses, hitm, count };
+
+#if defined(__linux__)
+    void open_(event e, std::uint32_t type, std::uint64_t config, bool inherit) noexcept {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = inherit ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Scale for multiplexing when more events are asked for than the PMU has
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds_[e] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    void ioctl_all_(unsigned long req) noexcept {
+        for (int fd : fds_) {
+            if (fd >= 0) ::ioctl(fd, req, 0);
+        }
+    }
+
+    std::uint64_t read_(int e) const noexcept {
+        if (fds_[e] < 0) return 0;
+        std::uint64_t buf[3] = {0, 0, 0}; // value, time enabled, time running
+        if (::read(fds_[e], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) {
+            return 0;
+        }
+        if (buf[2] == buf[1]) return buf[0];
+        return static_cast<std::uint64_t>(static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]));
+    }
+#else
+    std::uint64_t read_(int) const noexcept { return 0; }
+#endif
+
+    int fds_[count] = {-1, -1, -1, -1, -1};
+};
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "pipeline.hpp"
+
+struct record {
+    std::uint64_t seq;
+    std::uint64_t value;
+    std::uint64_t checksum;
+};
+
+// --------------------------------------------------
+// 4-stage pipeline: source -> parse -> enrich -> sink
+// Args:
+//   0 -> items per iteration
+//   1 -> batch size
+//   2 -> parallelism of the middle stages
+//   3 -> pin (0/1)
+// --------------------------------------------------
+static void BM_Pipeline_4Stage(benchmark::State& state) {
+    const std::uint64_t items = static_cast<std::uint64_t>(state.range(0));
+
+    stel::pipeline<record>::options opt;
+    opt.batch = static_cast<std::size_t>(state.range(1));
+    const std::size_t par = static_cast<std::size_t>(state.range(2));
+    opt.pin = state.range(3) != 0;
+
+    double occupancy[4] = {};
+    double stage_rate[4] = {};
+
+    for (auto _ : state) {
+        std::uint64_t next = 0;
+        std::uint64_t sink = 0;
+
+        stel::pipeline<record> p(opt);
+        p.source("source", [&](record& r) {
+            if (next == items) return false;
+            r.seq = next++;
+            r.value = r.seq * 7;
+            return true;
+        })
+        .stage("parse", [](record& r) { r.checksum = r.value ^ (r.value >> 3); }, par)
+        .stage("enrich", [](record& r) { r.checksum += r.seq; }, par)
+        .stage("sink", [&](record& r) { sink += r.checksum; });
+
+        p.start();
+        // Occupancy is interesting while running, sample it once halfway through.
+        // stats() allocates, so poll it with a sleep rather than spinning against
+        // the stage threads being measured.
+        while (p.stats()[0].items < items / 2) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        const auto mid = p.stats();
+        p.wait();
+        const auto end = p.stats();
+        for (int s = 0; s < 4; ++s) {
+            occupancy[s] += mid[s].occupancy;
+            stage_rate[s] += end[s].items_per_sec;
+        }
+        benchmark::DoNotOptimize(sink);
+    }
+
+    const double n = static_cast<double>(state.iterations());
+    const char* names[4] = {"source", "parse", "enrich", "sink"};
+    for (int s = 1; s < 4; ++s) {
+        state.counters[std::string(names[s]) + "_occ"] = occupancy[s] / n;
+    }
+    for (int s = 0; s < 4; ++s) {
+        state.counters[std::string(names[s]) + "_items/s"] = stage_rate[s] / n;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+}
+BENCHMARK(BM_Pipeline_4Stage)
+    ->Args({1 << 20, 1, 1, 1})
+    ->Args({1 << 20, 32, 1, 1})
+    ->Args({1 << 20, 256, 1, 1})
+    ->Args({1 << 20, 32, 2, 1})
+    ->Args({1 << 20, 32, 1, 0})
+    ->UseRealTime()
+    ->Iterations(3);
+
+BENCHMARK_MAIN();
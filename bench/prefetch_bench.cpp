@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "affinity.hpp"
+#include "lock_free_mpmc_bounded.hpp"
+#include "lock_free_spsc.hpp"
+#include "prefetch.hpp"
+
+// Producer -> consumer transfer of N-byte payloads, with software prefetching
+// off or at the distance derived from the payload size. Both sides touch every
+// byte (the producer fills it, the consumer sums it), so a slot that isn't in
+// cache costs what it would in real code. The ring is sized well past L2 so
+// slots are cold by the time they come round again.
+//
+// Args:
+//   0 -> 1 = prefetch on, 0 = off
+
+template <std::size_t N>
+struct payload {
+    std::uint64_t words[N / 8];
+};
+
+static constexpr std::size_t ring_bytes = 8 << 20;
+static constexpr std::size_t items = 1 << 18;
+
+template <std::size_t N>
+static inline void fill(payload<N>& p, std::uint64_t v) {
+    for (auto& w : p.words) w = v;
+}
+
+template <std::size_t N>
+static inline std::uint64_t sum(const payload<N>& p) {
+    std::uint64_t s = 0;
+    for (auto w : p.words) s += w;
+    return s;
+}
+
+template <std::size_t N>
+static void BM_Prefetch_SPSC(benchmark::State& state) {
+    const std::size_t distance = state.range(0) ? stel::default_prefetch_distance(sizeof(payload<N>)) : 0;
+    lock_free_spsc_queue<payload<N>> q(ring_bytes / sizeof(payload<N>), distance);
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            stel::pin_current_thread(1);
+            payload<N> p;
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < items; ++i) {
+                while (!q.try_pop(p)) { }
+                total += sum(p);
+            }
+            benchmark::DoNotOptimize(total);
+        });
+        stel::scoped_pin pin(0);
+        payload<N> p;
+        for (std::size_t i = 0; i < items; ++i) {
+            fill(p, i);
+            while (!q.try_push(p)) { }
+        }
+        consumer.join();
+    }
+    state.counters["distance"] = static_cast<double>(distance);
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(items * N * state.iterations()));
+}
+
+template <std::size_t N>
+static void BM_Prefetch_MPMC(benchmark::State& state) {
+    const std::size_t distance = state.range(0) ? stel::default_prefetch_distance(sizeof(payload<N>)) : 0;
+    std::size_t cap = 1;
+    while (cap * 2 * sizeof(payload<N>) <= ring_bytes) cap *= 2;
+    mpmc_bounded_queue<payload<N>> q(cap, distance);
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            stel::pin_current_thread(1);
+            payload<N> p;
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < items; ++i) {
+                while (!q.try_dequeue(p)) { }
+                total += sum(p);
+            }
+            benchmark::DoNotOptimize(total);
+        });
+        stel::scoped_pin pin(0);
+        payload<N> p;
+        for (std::size_t i = 0; i < items; ++i) {
+            fill(p, i);
+            while (!q.try_enqueue(p)) { }
+        }
+        consumer.join();
+    }
+    state.counters["distance"] = static_cast<double>(distance);
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(items * N * state.iterations()));
+}
+
+#define PREFETCH_SIZES(fn) \
+    BENCHMARK(fn<8>)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond); \
+    BENCHMARK(fn<64>)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond); \
+    BENCHMARK(fn<256>)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond); \
+    BENCHMARK(fn<1024>)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+PREFETCH_SIZES(BM_Prefetch_SPSC)
+PREFETCH_SIZES(BM_Prefetch_MPMC)
+
+BENCHMARK_MAIN();
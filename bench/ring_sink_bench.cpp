@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+
+#include "ring_sink.hpp"
+
+struct capture_record {
+    std::uint64_t ts;
+    std::uint64_t data[7];
+};
+
+static constexpr const char* sink_path = "/tmp/ring_sink_bench.bin";
+
+// Producer pushes as fast as it can. Time spent spinning on a full
+// ring is the stall the sink is supposed to hide.
+template <typename Consumer>
+static void run_capture(benchmark::State& state, std::size_t records, Consumer&& start_consumer) {
+    double stall_ns = 0;
+    for (auto _ : state) {
+        lock_free_spsc_queue<capture_record> ring(1 << 14);
+        auto stop_consumer = start_consumer(ring);
+
+        std::chrono::nanoseconds stalled{0};
+        for (std::size_t i = 0; i < records; ++i) {
+            capture_record r{i, {}};
+            if (!ring.try_push(r)) {
+                const auto t0 = std::chrono::steady_clock::now();
+                while (!ring.try_push(r)) { }
+                stalled += std::chrono::steady_clock::now() - t0;
+            }
+        }
+        stop_consumer();
+        stall_ns += static_cast<double>(stalled.count());
+    }
+    ::unlink(sink_path);
+
+    state.SetBytesProcessed(static_cast<int64_t>(records * sizeof(capture_record) * state.iterations()));
+    state.counters["producer_stall_ms"] = stall_ns / 1e6 / static_cast<double>(state.iterations());
+}
+
+// --------------------------------------------------
+// ring_sink: bulk drain + double-buffered writev
+// Args:
+//   0 -> records
+//   1 -> buffer size (KB)
+//   2 -> buffers
+//   3 -> O_DIRECT (0/1)
+// --------------------------------------------------
+static void BM_RingSink(benchmark::State& state) {
+    stel::ring_sink<capture_record>::options opt;
+    opt.buffer_bytes = static_cast<std::size_t>(state.range(1)) << 10;
+    opt.buffers = static_cast<std::size_t>(state.range(2));
+    opt.direct = state.range(3) != 0;
+    std::uint64_t writes = 0;
+    std::uint64_t stalls = 0;
+
+    run_capture(state, static_cast<std::size_t>(state.range(0)), [&](auto& ring) {
+        auto sink = std::make_shared<stel::ring_sink<capture_record>>(ring, sink_path, opt);
+        return [&, sink] {
+            sink->stop();
+            writes += sink->writes();
+            stalls += sink->stalls();
+        };
+    });
+    state.counters["writes"] = static_cast<double>(writes) / static_cast<double>(state.iterations());
+    state.counters["sink_stalls"] = static_cast<double>(stalls) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_RingSink)
+    ->Args({1 << 22, 1024, 2, 0})
+    ->Args({1 << 22, 1024, 4, 0})
+    ->Args({1 << 22, 4096, 2, 0})
+    ->Args({1 << 22, 1024, 2, 1})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
+// --------------------------------------------------
+// Baseline: consumer pops one item at a time and fwrite()s it
+// --------------------------------------------------
+static void BM_PopFwrite(benchmark::State& state) {
+    run_capture(state, static_cast<std::size_t>(state.range(0)), [&](auto& ring) {
+        auto stop = std::make_shared<std::atomic<bool>>(false);
+        auto consumer = std::make_shared<std::thread>([&ring, stop] {
+            std::FILE* f = std::fopen(sink_path, "wb");
+            capture_record r;
+            for (;;) {
+                if (ring.try_pop(r)) {
+                    std::fwrite(&r, sizeof(r), 1, f);
+                } else if (stop->load(std::memory_order_acquire) && ring.empty()) {
+                    break;
+                }
+            }
+            std::fclose(f);
+        });
+        return [stop, consumer] {
+            stop->store(true, std::memory_order_release);
+            consumer->join();
+        };
+    });
+}
+BENCHMARK(BM_PopFwrite)
+    ->Arg(1 << 22)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,198 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "affinity.hpp"
+#include "backoff.hpp"
+#include "lock_free_spsc.hpp"
+#include "non_safe_spsc.hpp"
+
+// SPSC throughput by payload: trivially copyable structs of 8B to 4KB, and the
+// non-trivial types we actually ship (short and long std::string, a byte vector).
+// Reports items/s and bytes/s - items/s falls with size while bytes/s climbs until
+// it flattens out at whatever the copy (or the cache-to-cache transfer) can do.
+//
+// For the non-trivial types "bytes" is the payload the type carries, not
+// sizeof(T): building, moving and freeing the heap part is the cost being measured.
+//
+// Two shapes:
+//	* BM_SPSC_Payload: lock_free_spsc_queue, producer on cpu 0, consumer on cpu 1
+//	* BM_*_Payload_SameThread: fill the ring, drain it, one thread. spsc_queue isn't
+//	  thread safe, so this is the only way to put it next to lock_free_spsc_queue;
+//	  it shows the copy cost without the cross-core traffic.
+
+static constexpr std::size_t ring_capacity = 1024;
+
+template <std::size_t N>
+struct payload {
+    std::uint64_t words[N / 8];
+};
+
+// How to make, consume and size each payload type
+template <typename T>
+struct payload_traits;
+
+template <std::size_t N>
+struct payload_traits<payload<N>> {
+    static constexpr std::size_t bytes = N;
+    static payload<N> make(std::uint64_t v) {
+        payload<N> p;
+        std::fill(std::begin(p.words), std::end(p.words), v);
+        return p;
+    }
+    static std::uint64_t touch(const payload<N>& p) { return p.words[0] + p.words[N / 8 - 1]; }
+};
+
+// Fits the small string buffer, no allocation
+struct short_string { };
+// Past SSO, one allocation per item
+struct long_string { };
+
+template <>
+struct payload_traits<short_string> {
+    using type = std::string;
+    static constexpr std::size_t bytes = 15;
+    static std::string make(std::uint64_t v) { return std::string(bytes, static_cast<char>('a' + v % 26)); }
+    static std::uint64_t touch(const std::string& s) { return s.size() + static_cast<unsigned char>(s.back()); }
+};
+
+template <>
+struct payload_traits<long_string> {
+    using type = std::string;
+    static constexpr std::size_t bytes = 256;
+    static std::string make(std::uint64_t v) { return std::string(bytes, static_cast<char>('a' + v % 26)); }
+    static std::uint64_t touch(const std::string& s) { return s.size() + static_cast<unsigned char>(s.back()); }
+};
+
+template <>
+struct payload_traits<std::vector<std::uint8_t>> {
+    static constexpr std::size_t bytes = 1024;
+    static std::vector<std::uint8_t> make(std::uint64_t v) {
+        return std::vector<std::uint8_t>(bytes, static_cast<std::uint8_t>(v));
+    }
+    static std::uint64_t touch(const std::vector<std::uint8_t>& b) { return b.empty() ? 0 : b.size() + b[b.size() - 1]; }
+};
+
+// The queued type: the traits' `type` when the tag isn't the type itself
+template <typename P, typename = void>
+struct value_of { using type = P; };
+template <typename P>
+struct value_of<P, std::void_t<typename payload_traits<P>::type>> { using type = typename payload_traits<P>::type; };
+template <typename P>
+using value_t = typename value_of<P>::type;
+
+// ~16MB through the queue per iteration, within sane item counts
+template <typename P>
+static constexpr std::size_t items_for() {
+    return std::clamp<std::size_t>((16u << 20) / payload_traits<P>::bytes, 4096, 1 << 18);
+}
+
+template <typename P>
+static void set_rates(benchmark::State& state, std::size_t items) {
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(items * payload_traits<P>::bytes * state.iterations()));
+}
+
+template <typename P>
+static void BM_SPSC_Payload(benchmark::State& state) {
+    using T = value_t<P>;
+    using traits = payload_traits<P>;
+    constexpr std::size_t items = items_for<P>();
+    lock_free_spsc_queue<T> q(ring_capacity);
+
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            stel::pin_current_thread(1);
+            T v;
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < items; ++i) {
+                stel::backoff b;
+                while (!q.try_pop(v)) b.pause();
+                total += traits::touch(v);
+            }
+            benchmark::DoNotOptimize(total);
+        });
+        stel::scoped_pin pin(0);
+        for (std::size_t i = 0; i < items; ++i) {
+            T v = traits::make(i);
+            // Wait for room first, try_push takes the value even when it fails
+            stel::backoff b;
+            while (q.full()) b.pause();
+            q.try_push(std::move(v));
+        }
+        consumer.join();
+    }
+    set_rates<P>(state, items);
+}
+
+template <typename P>
+static void BM_LockFreeSPSC_Payload_SameThread(benchmark::State& state) {
+    using T = value_t<P>;
+    using traits = payload_traits<P>;
+    constexpr std::size_t items = items_for<P>();
+    lock_free_spsc_queue<T> q(ring_capacity);
+
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        T v;
+        for (std::size_t done = 0; done < items; ) {
+            std::size_t batch = 0;
+            while (done + batch < items && !q.full()) {
+                q.try_push(traits::make(done + batch));
+                ++batch;
+            }
+            while (q.try_pop(v)) total += traits::touch(v);
+            done += batch;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_rates<P>(state, items);
+}
+
+template <typename P>
+static void BM_NonSafeSPSC_Payload_SameThread(benchmark::State& state) {
+    using T = value_t<P>;
+    using traits = payload_traits<P>;
+    constexpr std::size_t items = items_for<P>();
+    // T buffer[Size] lives inside the object - too big for the stack at 4KB items
+    auto q = std::make_unique<spsc_queue<T, ring_capacity>>();
+
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        T v;
+        for (std::size_t done = 0; done < items; ) {
+            std::size_t batch = 0;
+            while (done + batch < items && q->try_push(traits::make(done + batch))) ++batch;
+            // Move out like lock_free_spsc_queue::try_pop does - front() would copy
+            while (T* p = q->peek()) {
+                v = std::move(*p);
+                total += traits::touch(v);
+                q->try_pop();
+            }
+            done += batch;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_rates<P>(state, items);
+}
+
+#define SPSC_PAYLOADS(bench) \
+    BENCHMARK_TEMPLATE(bench, payload<8>)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(bench, payload<64>)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(bench, payload<256>)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(bench, payload<1024>)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(bench, payload<4096>)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(bench, short_string)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(bench, long_string)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(bench, std::vector<std::uint8_t>)->UseRealTime()
+
+SPSC_PAYLOADS(BM_SPSC_Payload);
+SPSC_PAYLOADS(BM_LockFreeSPSC_Payload_SameThread);
+SPSC_PAYLOADS(BM_NonSafeSPSC_Payload_SameThread);
+
+BENCHMARK_MAIN();
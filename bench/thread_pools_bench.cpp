@@ -11,6 +11,7 @@
 #include <latch>
 
 #include "bounded_mpmc_pool.hpp"
+#include "perf_counters.hpp"
 #include "thread_pool.hpp"
 
 using BoundedPool = stel::bounded_mpmc_pool;
@@ -36,17 +37,22 @@ static inline void do_work_ns(uint64_t ns) {
 //   1 -> capacity (queue size)
 //   2 -> tasks per iteration
 //   3 -> per-task work (ns)
+//   4 -> max spinning workers
 // --------------------------------------
 static void BM_BoundedPool_Submit(benchmark::State& state) {
     const std::size_t workers   = static_cast<std::size_t>(state.range(0));
     const std::size_t capacity  = static_cast<std::size_t>(state.range(1));
     const std::size_t tasks     = static_cast<std::size_t>(state.range(2));
     const uint64_t    work_ns   = static_cast<uint64_t>(state.range(3));
+    const std::size_t spinners  = static_cast<std::size_t>(state.range(4));
+
+    // Opened before the pool so its workers inherit the counters
+    perf_counters perf;
 
     // One pool per benchmark config
     static std::unique_ptr<BoundedPool> pool;
     if (state.thread_index() == 0) {
-        pool = std::make_unique<BoundedPool>(workers, capacity);
+        pool = std::make_unique<BoundedPool>(workers, capacity, spinners);
     }
 
     // Ensure all threads see 'pool'
@@ -56,7 +62,11 @@ static void BM_BoundedPool_Submit(benchmark::State& state) {
     state.counters["capacity"]  = benchmark::Counter(double(capacity), benchmark::Counter::kAvgThreads);
     state.counters["tasks"]     = benchmark::Counter(double(tasks),    benchmark::Counter::kAvgThreads);
     state.counters["work_ns"]   = benchmark::Counter(double(work_ns),  benchmark::Counter::kAvgThreads);
+    state.counters["spinners"]  = benchmark::Counter(double(spinners), benchmark::Counter::kAvgThreads);
+
+    const std::uint64_t wakeups_before = pool->wakeups();
 
+    perf.start();
     for (auto _ : state) {
         state.PauseTiming();
         // We’ll submit from the benchmark thread only (single producer)
@@ -77,14 +87,26 @@ static void BM_BoundedPool_Submit(benchmark::State& state) {
         state.SetItemsProcessed(state.items_processed() + static_cast<int64_t>(tasks));
     }
 
+    // Sleeping workers woken per submitted task - the cost the spinner throttling cuts
+    state.counters["wakeups/task"] = benchmark::Counter(
+        double(pool->wakeups() - wakeups_before) / double(tasks * state.iterations()),
+        benchmark::Counter::kAvgThreads);
+
     if (state.thread_index() == 0) {
         pool->shutdown();
         pool.reset();
     }
+    // Workers' counts only arrive once they have exited
+    perf.stop();
+    perf.report(state, double(tasks * state.iterations()));
 }
 BENCHMARK(BM_BoundedPool_Submit)
-    ->Args({16, 256, 1<<20, 0})          // 16 workers, cap 256, 1M no-op tasks
-    ->Args({16, 256, 1<<20, 500})        // add 500ns of work per task
+    ->Args({16, 256, 1<<20, 0, 2})       // 16 workers, cap 256, 1M no-op tasks, 2 spinners
+    ->Args({16, 256, 1<<20, 500, 2})     // add 500ns of work per task
+    ->Args({16, 256, 1<<20, 0, 1})       // spinner sweep
+    ->Args({16, 256, 1<<20, 500, 1})
+    ->Args({16, 256, 1<<20, 0, 16})      // everyone may spin
+    ->Args({16, 256, 1<<20, 500, 16})
     ->UseRealTime()
     ->Iterations(3)
     ->Threads(1);
@@ -101,6 +123,8 @@ static void BM_MutexPool_Submit(benchmark::State& state) {
     const std::size_t tasks     = static_cast<std::size_t>(state.range(1));
     const uint64_t    work_ns   = static_cast<uint64_t>(state.range(2));
 
+    perf_counters perf;
+
     static std::unique_ptr<MutexPool> pool;
     if (state.thread_index() == 0) {
         pool = std::make_unique<MutexPool>(workers);
@@ -111,6 +135,7 @@ static void BM_MutexPool_Submit(benchmark::State& state) {
     state.counters["tasks"]   = benchmark::Counter(double(tasks),   benchmark::Counter::kAvgThreads);
     state.counters["work_ns"] = benchmark::Counter(double(work_ns), benchmark::Counter::kAvgThreads);
 
+    perf.start();
     for (auto _ : state) {
         state.PauseTiming();
         std::latch done(tasks);
@@ -131,6 +156,8 @@ static void BM_MutexPool_Submit(benchmark::State& state) {
         pool->shutdown();
         pool.reset();
     }
+    perf.stop();
+    perf.report(state, double(tasks * state.iterations()));
 }
 
 BENCHMARK(BM_MutexPool_Submit)
@@ -140,4 +167,62 @@ BENCHMARK(BM_MutexPool_Submit)
     ->Iterations(3)
     ->Threads(1);
 
+// -------------------------------------------------
+// Benchmark 3: cost of frequent wait_idle() barriers
+// Submit a small batch, then block until the pool is quiescent, over and over.
+// Args:
+//   0 -> workers
+//   1 -> tasks per barrier
+//   2 -> barriers per iteration
+// -------------------------------------------------
+template <typename Pool>
+static void BM_Pool_WaitIdle(benchmark::State& state, Pool& pool) {
+    const std::size_t tasks    = static_cast<std::size_t>(state.range(1));
+    const std::size_t barriers = static_cast<std::size_t>(state.range(2));
+
+    std::atomic<std::uint64_t> sink{0};
+    for (auto _ : state) {
+        for (std::size_t b = 0; b < barriers; ++b) {
+            for (std::size_t i = 0; i < tasks; ++i) {
+                pool.submit([&sink]{ sink.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.wait_idle();
+        }
+    }
+    benchmark::DoNotOptimize(sink.load());
+
+    state.SetItemsProcessed(static_cast<int64_t>(tasks * barriers * state.iterations()));
+    state.counters["barriers/s"] = benchmark::Counter(
+        static_cast<double>(barriers * state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["s/barrier"] = benchmark::Counter(
+        static_cast<double>(barriers * state.iterations()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void BM_BoundedPool_WaitIdle(benchmark::State& state) {
+    BoundedPool pool(static_cast<std::size_t>(state.range(0)), 1024);
+    BM_Pool_WaitIdle(state, pool);
+    pool.drain();
+}
+
+static void BM_MutexPool_WaitIdle(benchmark::State& state) {
+    MutexPool pool(static_cast<std::size_t>(state.range(0)));
+    BM_Pool_WaitIdle(state, pool);
+    pool.drain();
+}
+
+BENCHMARK(BM_BoundedPool_WaitIdle)
+    ->Args({16, 1, 10000})               // barrier after every task
+    ->Args({16, 16, 10000})
+    ->Args({16, 256, 1000})
+    ->UseRealTime()
+    ->Iterations(3);
+
+BENCHMARK(BM_MutexPool_WaitIdle)
+    ->Args({16, 1, 10000})
+    ->Args({16, 16, 10000})
+    ->Args({16, 256, 1000})
+    ->UseRealTime()
+    ->Iterations(3);
+
 BENCHMARK_MAIN();
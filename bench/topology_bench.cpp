@@ -0,0 +1,312 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "backoff.hpp"
+#include "hdr_histogram.hpp"
+#include "lock_free_spsc.hpp"
+
+// Producer/consumer placement matrix. Reads the CPU topology from sysfs, picks one
+// representative CPU pair per relationship class and runs the same benchmarks
+// pinned to each:
+//
+//	smt_sibling   two hardware threads of one core (share L1/L2)
+//	same_l3       different cores behind one L3
+//	same_package  one socket, different L3 (AMD CCXs, Intel sub-NUMA clusters)
+//	same_package_unknown_l3  one socket, sysfs doesn't say which CPUs share an L3
+//	cross_socket  different packages, traffic goes over the interconnect
+//	os            no pinning, wherever the scheduler puts them
+//
+// Per class: lock_free_spsc_queue throughput, SPSC round-trip latency, and a raw
+// cache-line ping-pong - one atomic bounced between the two CPUs, no queue at all.
+// The ping-pong is the floor for the class; queue latency minus it is what the
+// queue itself costs.
+//
+// Classes the machine doesn't have (no SMT, single socket...) are not
+// registered. --benchmark_filter=smt_sibling etc. picks one class.
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t ring_capacity = 1024;
+constexpr std::size_t items = 1 << 20;
+constexpr int no_cpu = -1;
+
+struct cpu_info {
+    int cpu;
+    int package;
+    int smt; // lowest CPU among this core's hardware threads
+    int l3; // lowest CPU sharing this CPU's L3, -1 if unknown
+};
+
+std::string read_line(const std::string& path) {
+    std::ifstream f(path);
+    std::string s;
+    std::getline(f, s);
+    return s;
+}
+
+int read_int(const std::string& path, int fallback) {
+    const std::string s = read_line(path);
+    return s.empty() ? fallback : std::stoi(s);
+}
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) continue;
+        const auto dash = range.find('-');
+        const int lo = std::stoi(range.substr(0, dash));
+        const int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+std::vector<int> online_cpus() {
+    return parse_cpu_list(read_line("/sys/devices/system/cpu/online"));
+}
+
+// core_id is only unique within a package and is not even that on some hybrid
+// and virtualised parts, so siblings come from the kernel's own list
+int smt_group(int cpu) {
+    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+    auto siblings = parse_cpu_list(read_line(base + "thread_siblings_list"));
+    if (siblings.empty()) siblings = parse_cpu_list(read_line(base + "core_cpus_list"));
+    return siblings.empty() ? cpu : siblings.front();
+}
+
+int l3_group(int cpu) {
+    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index";
+    for (int i = 0; i < 8; ++i) {
+        if (read_int(base + std::to_string(i) + "/level", 0) == 3) {
+            const auto shared = parse_cpu_list(read_line(base + std::to_string(i) + "/shared_cpu_list"));
+            return shared.empty() ? -1 : shared.front();
+        }
+    }
+    return -1;
+}
+
+std::vector<cpu_info> read_topology() {
+    std::vector<cpu_info> cpus;
+    for (int cpu : online_cpus()) {
+        const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        cpus.push_back(cpu_info{
+            cpu,
+            read_int(base + "physical_package_id", 0),
+            smt_group(cpu),
+            l3_group(cpu)
+        });
+    }
+    return cpus;
+}
+
+const char* classify(const cpu_info& a, const cpu_info& b) {
+    if (a.package != b.package) return "cross_socket";
+    if (a.smt == b.smt) return "smt_sibling";
+    // No L3 in sysfs (common in VMs): can't tell same_l3 from same_package
+    if (a.l3 < 0 || b.l3 < 0) return "same_package_unknown_l3";
+    if (a.l3 == b.l3) return "same_l3";
+    return "same_package";
+}
+
+// First pair found per class, preferring pairs that involve the lowest CPUs
+std::map<std::string, std::pair<int, int>> representative_pairs(const std::vector<cpu_info>& cpus) {
+    std::map<std::string, std::pair<int, int>> pairs;
+    for (std::size_t i = 0; i < cpus.size(); ++i) {
+        for (std::size_t j = i + 1; j < cpus.size(); ++j) {
+            pairs.emplace(classify(cpus[i], cpus[j]), std::make_pair(cpus[i].cpu, cpus[j].cpu));
+        }
+    }
+    pairs.emplace("os", std::make_pair(no_cpu, no_cpu));
+    return pairs;
+}
+
+// Pins to exactly `cpu` - unlike stel::pin_current_thread nothing is wrapped, the
+// pair comes straight from sysfs and landing on another CPU would report the
+// numbers under the wrong class. false if the affinity couldn't be set (offline
+// CPU, restricted cpuset).
+// no_cpu lets the thread run anywhere again - the benchmark thread is reused
+// across classes and would otherwise stay pinned from the previous one
+bool pin(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpu != no_cpu) {
+        CPU_SET(cpu, &set);
+    } else {
+        for (int c : online_cpus()) CPU_SET(c, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return cpu == no_cpu;
+#endif
+}
+
+// Checks both CPUs of the pair can be used before any thread starts and leaves the
+// calling thread on `a`. Otherwise the class is skipped rather than run unpinned.
+bool pin_pair(benchmark::State& state, int a, int b) {
+    if (pin(b) && pin(a)) return true;
+    pin(no_cpu);
+    state.SkipWithError(("can't pin to cpu" + std::to_string(a) + " and cpu" + std::to_string(b)).c_str());
+    return false;
+}
+
+std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_type::now().time_since_epoch()).count());
+}
+
+// Producer on `a`, consumer on `b`
+void spsc_throughput(benchmark::State& state, int a, int b) {
+    if (!pin_pair(state, a, b)) return;
+    lock_free_spsc_queue<std::uint64_t> q(ring_capacity);
+    std::atomic<bool> pin_failed{false};
+    for (auto _ : state) {
+        std::thread consumer([&] {
+            if (!pin(b)) pin_failed.store(true, std::memory_order_relaxed);
+            std::uint64_t v, sum = 0;
+            for (std::size_t i = 0; i < items; ++i) {
+                stel::backoff bo;
+                while (!q.try_pop(v)) bo.pause();
+                sum += v;
+            }
+            benchmark::DoNotOptimize(sum);
+        });
+        for (std::size_t i = 0; i < items; ++i) {
+            stel::backoff bo;
+            while (!q.try_push(i)) bo.pause();
+        }
+        consumer.join();
+    }
+    if (pin_failed.load()) state.SkipWithError(("can't pin to cpu" + std::to_string(b)).c_str());
+    state.SetItemsProcessed(static_cast<int64_t>(items * state.iterations()));
+}
+
+// One message in flight: `a` sends, `b` echoes it back over a second ring
+void spsc_round_trip(benchmark::State& state, int a, int b) {
+    if (!pin_pair(state, a, b)) return;
+    lock_free_spsc_queue<std::uint64_t> ping(ring_capacity), pong(ring_capacity);
+    std::atomic<bool> stop{false};
+    std::atomic<bool> pin_failed{false};
+    hdr_histogram hist;
+
+    std::thread echo([&] {
+        if (!pin(b)) pin_failed.store(true, std::memory_order_relaxed);
+        std::uint64_t v;
+        stel::backoff bo;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (ping.try_pop(v)) {
+                while (!pong.try_push(v)) { }
+                bo.reset();
+            } else {
+                bo.pause();
+            }
+        }
+    });
+
+    for (auto _ : state) {
+        while (!ping.try_push(now_ns())) { }
+        std::uint64_t sent;
+        stel::backoff bo;
+        while (!pong.try_pop(sent)) bo.pause();
+        hist.record(now_ns() - sent);
+    }
+    stop.store(true, std::memory_order_relaxed);
+    echo.join();
+    if (pin_failed.load()) state.SkipWithError(("can't pin to cpu" + std::to_string(b)).c_str());
+    hist.report(state);
+}
+
+// The bare cost of moving one line between the two CPUs and back: `a` writes an
+// odd value, `b` answers with the next even one
+void cache_line_ping_pong(benchmark::State& state, int a, int b) {
+    struct alignas(hardware_destructive_interference_size) line {
+        std::atomic<std::uint64_t> v{0};
+    };
+    if (!pin_pair(state, a, b)) return;
+    line l;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> pin_failed{false};
+    hdr_histogram hist;
+
+    std::thread echo([&] {
+        if (!pin(b)) pin_failed.store(true, std::memory_order_relaxed);
+        std::uint64_t seen = 0;
+        stel::backoff bo;
+        while (!stop.load(std::memory_order_relaxed)) {
+            const std::uint64_t v = l.v.load(std::memory_order_acquire);
+            if (v != seen && (v & 1)) {
+                l.v.store(v + 1, std::memory_order_release);
+                seen = v + 1;
+                bo.reset();
+            } else {
+                bo.pause();
+            }
+        }
+    });
+
+    std::uint64_t seq = 1;
+    for (auto _ : state) {
+        const std::uint64_t t0 = now_ns();
+        l.v.store(seq, std::memory_order_release);
+        stel::backoff bo;
+        while (l.v.load(std::memory_order_acquire) != seq + 1) bo.pause();
+        hist.record(now_ns() - t0);
+        seq += 2;
+    }
+    stop.store(true, std::memory_order_relaxed);
+    echo.join();
+    if (pin_failed.load()) state.SkipWithError(("can't pin to cpu" + std::to_string(b)).c_str());
+    hist.report(state);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    const auto cpus = read_topology();
+    const auto pairs = representative_pairs(cpus);
+    for (const auto& [cls, p] : pairs) {
+        const int a = p.first, b = p.second;
+        const std::string where = a == no_cpu ? cls : cls + "/cpu" + std::to_string(a) + "-cpu" + std::to_string(b);
+        std::fprintf(stderr, "%-13s %s\n", cls.c_str(),
+                     a == no_cpu ? "unpinned" : ("cpu" + std::to_string(a) + " <-> cpu" + std::to_string(b)).c_str());
+
+        benchmark::RegisterBenchmark(("BM_Topology_SPSC_Throughput/" + where).c_str(),
+            [a, b](benchmark::State& s) { spsc_throughput(s, a, b); })
+            ->Iterations(5)->UseRealTime()->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("BM_Topology_SPSC_RoundTrip/" + where).c_str(),
+            [a, b](benchmark::State& s) { spsc_round_trip(s, a, b); })
+            ->Iterations(100000)->UseRealTime();
+        benchmark::RegisterBenchmark(("BM_Topology_PingPong/" + where).c_str(),
+            [a, b](benchmark::State& s) { cache_line_ping_pong(s, a, b); })
+            ->Iterations(100000)->UseRealTime();
+    }
+    if (pairs.size() == 1) {
+        std::fprintf(stderr, "only %zu online cpu(s), no pairs to pin - running unpinned only\n", cpus.size());
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
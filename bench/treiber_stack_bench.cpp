@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "lock_free_mpmc_bounded.hpp"
+#include "treiber_stack.hpp"
+
+// Freelist traffic: every thread takes a burst of indices and gives them back.
+// Each index names a 64-byte slot that gets written on acquire, so LIFO reuse
+// (the slot just released, still in cache) shows up against FIFO (the coldest slot).
+static constexpr std::size_t slots = 1 << 16;
+static constexpr std::size_t burst = 8;
+
+struct alignas(64) slot { std::uint64_t data[8]; };
+static std::unique_ptr<slot[]> storage;
+
+static inline void touch(std::uint32_t idx) {
+    slot& s = storage[idx];
+    for (auto& d : s.data) d = idx;
+    benchmark::DoNotOptimize(s);
+}
+
+static void BM_Freelist_MPMC(benchmark::State& state) {
+    static std::unique_ptr<mpmc_bounded_queue<std::uint32_t>> q;
+    if (state.thread_index() == 0) {
+        storage = std::make_unique<slot[]>(slots);
+        q = std::make_unique<mpmc_bounded_queue<std::uint32_t>>(slots);
+        for (std::uint32_t i = 0; i < slots; ++i) q->try_enqueue(i);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::array<std::uint32_t, burst> held{};
+    for (auto _ : state) {
+        std::size_t n = 0;
+        while (n < burst && q->try_dequeue(held[n])) touch(held[n++]);
+        for (std::size_t i = 0; i < n; ++i) q->try_enqueue(held[i]);
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_Freelist_MPMC)->ThreadRange(1, 16)->UseRealTime();
+
+// Args:
+//   0 -> elimination slots (0 = plain Treiber stack)
+static void BM_Freelist_TreiberStack(benchmark::State& state) {
+    static std::unique_ptr<stel::index_stack> s;
+    if (state.thread_index() == 0) {
+        storage = std::make_unique<slot[]>(slots);
+        stel::index_stack::options opt;
+        opt.elimination_slots = static_cast<std::size_t>(state.range(0));
+        s = std::make_unique<stel::index_stack>(slots, true, opt);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::array<std::uint32_t, burst> held{};
+    for (auto _ : state) {
+        std::size_t n = 0;
+        while (n < burst && s->try_pop(held[n])) touch(held[n++]);
+        for (std::size_t i = 0; i < n; ++i) s->push(held[i]);
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+    if (state.thread_index() == 0) {
+        state.counters["eliminated"] = static_cast<double>(s->eliminated());
+    }
+}
+BENCHMARK(BM_Freelist_TreiberStack)->Arg(0)->Arg(8)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
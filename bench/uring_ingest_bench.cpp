@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "lock_free_spsc.hpp"
+#include "uring_ingest.hpp"
+
+// Capture file format used here: fixed 64-byte records
+struct record {
+    std::uint64_t words[8];
+};
+
+static constexpr std::size_t file_bytes = std::size_t(256) << 20;
+
+// One capture file for the whole run. It sits in the page cache after the
+// first pass, so this measures the ingest path rather than the device.
+// Removed again at exit.
+struct capture {
+    std::string path = "/tmp/uring_ingest_bench.bin";
+
+    capture() {
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        std::vector<char> block(1 << 20, 'x');
+        for (std::size_t done = 0; done < file_bytes; done += block.size()) {
+            if (::write(fd, block.data(), block.size()) < 0) break;
+        }
+        ::close(fd);
+    }
+    ~capture() { ::unlink(path.c_str()); }
+};
+
+static const std::string& capture_file() {
+    static const capture file;
+    return file.path;
+}
+
+// Touch every record like a real consumer would
+static inline std::uint64_t consume(const std::byte* data, std::size_t size) {
+    std::uint64_t sum = 0;
+    for (std::size_t off = 0; off + sizeof(record) <= size; off += sizeof(record)) {
+        std::uint64_t w;
+        std::memcpy(&w, data + off, sizeof(w));
+        sum += w;
+    }
+    return sum;
+}
+
+// --------------------------------------------------
+// file_ingest: reads land in ring-owned buffers, consumer reads in place
+// Args:
+//   0 -> use io_uring (0 = pread fallback)
+//   1 -> chunk size (KB)
+// --------------------------------------------------
+static void BM_FileIngest(benchmark::State& state) {
+    const std::string& path = capture_file();
+    stel::file_ingest::options opt;
+    opt.use_uring = state.range(0) != 0;
+    opt.chunk_size = static_cast<std::size_t>(state.range(1)) << 10;
+    opt.record_size = sizeof(record);
+
+    bool uring = false;
+    for (auto _ : state) {
+        stel::file_ingest in(path.c_str(), opt);
+        stel::ingest_chunk c;
+        std::uint64_t sum = 0;
+        while (in.next(c)) {
+            sum += consume(c.data, c.size);
+            in.release(c);
+        }
+        uring = in.using_uring();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["uring"] = uring ? 1 : 0;
+    state.SetBytesProcessed(static_cast<int64_t>(file_bytes * state.iterations()));
+}
+BENCHMARK(BM_FileIngest)
+    ->Args({1, 256})
+    ->Args({1, 1024})
+    ->Args({0, 256})
+    ->Args({0, 1024})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
+// --------------------------------------------------
+// Baseline: read() into a buffer, copy every record into
+// a lock_free_spsc_queue, consumer thread pops them
+// Args:
+//   0 -> read size (KB)
+// --------------------------------------------------
+static void BM_ReadPlusPush(benchmark::State& state) {
+    const std::string& path = capture_file();
+    const std::size_t read_size = static_cast<std::size_t>(state.range(0)) << 10;
+    std::vector<std::byte> buf(read_size);
+
+    for (auto _ : state) {
+        lock_free_spsc_queue<record> q(1 << 14);
+        std::atomic<bool> eof{false};
+
+        std::thread consumer([&] {
+            record r;
+            std::uint64_t sum = 0;
+            for (;;) {
+                if (q.try_pop(r)) {
+                    sum += r.words[0];
+                } else if (eof.load(std::memory_order_acquire) && q.empty()) {
+                    break;
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        });
+
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        ssize_t n;
+        while ((n = ::read(fd, buf.data(), buf.size())) > 0) {
+            for (std::size_t off = 0; off + sizeof(record) <= static_cast<std::size_t>(n); off += sizeof(record)) {
+                record r;
+                std::memcpy(&r, buf.data() + off, sizeof(r));
+                while (!q.try_push(r)) { }
+            }
+        }
+        ::close(fd);
+        eof.store(true, std::memory_order_release);
+        consumer.join();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(file_bytes * state.iterations()));
+}
+BENCHMARK(BM_ReadPlusPush)
+    ->Arg(256)
+    ->Arg(1024)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
+BENCHMARK_MAIN();
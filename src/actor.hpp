@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "backoff.hpp"
+#include "lock_free_mpsc.hpp"
+#include "thread_pool.hpp"
+
+namespace stel {
+
+// Lightweight actor on top of a thread pool
+//
+// Every actor owns a lock free MPSC mailbox. send() bumps pending_ and then pushes
+// the message; only the send that takes pending_ from 0 to 1 schedules the actor on
+// the pool. The scheduled run processes up to `batch` messages, subtracts what it
+// processed and reschedules itself if anything is left. Counting before pushing
+// keeps pending_ >= what the mailbox holds, so a run can never pop a message that
+// isn't counted yet and wrap pending_ - a counted message that isn't visible yet
+// just makes the run come back for it. So at most one run of an
+// actor is queued or executing at any time - the handler never runs concurrently
+// with itself and needs no locking of its own state - while an idle actor costs
+// nothing on the pool.
+//
+// The batch bounds how long one busy actor can hold a worker, so actors sharing
+// the pool still get turns.
+//
+// The pool and the actor must outlive all in-flight messages: stop sending, wait for
+// the pool to go idle (pool.wait_idle()), then destroy actors before the pool.
+//
+// Once the pool stops accepting tasks (drain() or shutdown()) the actor can't be
+// scheduled any more: whatever is in its mailbox is dropped and the actor goes
+// back to idle. send() returns false when it is the one that ran into this;
+// messages sent around the same time by other threads may be dropped as well.
+//
+// Mailbox is anything with the lock_free_mpsc_queue push()/try_pop() interface.
+template <typename Msg, typename Pool = thread_pool, typename Mailbox = lock_free_mpsc_queue<Msg>>
+class actor {
+public:
+	using handler = std::function<void(Msg&)>;
+
+	actor(Pool& pool, handler h, std::size_t batch = 64)
+		: pool_(pool), handler_(std::move(h)), batch_(batch == 0 ? 1 : batch), pending_(0)
+	{ }
+
+	actor(const actor&) = delete;
+	actor& operator =(const actor&) = delete;
+	actor(actor&&) = delete;
+	actor& operator =(actor&&) = delete;
+
+	~actor() {
+		assert(idle() && "actor destroyed with messages in flight");
+	}
+
+	// Any thread, including from inside another actor's (or this actor's) handler.
+	// false: the pool refused to run the actor, the message was dropped.
+	bool send(Msg m) {
+		const bool first = pending_.fetch_add(1, std::memory_order_acq_rel) == 0;
+		mailbox_.push(std::move(m));
+		return first ? schedule_() : true;
+	}
+
+	// Messages sent and not processed yet
+	std::size_t pending() const noexcept { return pending_.load(std::memory_order_relaxed); }
+	bool idle() const noexcept { return pending_.load(std::memory_order_acquire) == 0; }
+
+private:
+	bool schedule_() {
+		if (pool_.submit([this] { run_(); })) return true;
+		drop_all_();
+		return false;
+	}
+
+	// The pool won't run us again: drop the mailbox and uncount it, so the actor
+	// ends up idle instead of "scheduled" forever
+	void drop_all_() {
+		backoff b;
+		for (;;) {
+			std::size_t n = 0;
+			while (mailbox_.try_pop()) ++n;
+			if (pending_.fetch_sub(n, std::memory_order_acq_rel) == n) return;
+			// A sender has counted but not pushed (or linked) yet, or has just sent - go again
+			b.pause();
+		}
+	}
+
+	void run_() {
+		std::size_t n = 0;
+		while (n < batch_) {
+			auto m = mailbox_.try_pop();
+			// Either really empty, or a sender has counted its message but not pushed
+			// or linked it yet. pending_ tells which - in the second case we simply
+			// come back.
+			if (!m) break;
+			handler_(*m);
+			++n;
+		}
+
+		// acq_rel: the next run (on whatever worker) sees everything this one did
+		if (pending_.fetch_sub(n, std::memory_order_acq_rel) != n) {
+			schedule_();
+		}
+	}
+
+	Pool& pool_;
+	handler handler_;
+	const std::size_t batch_;
+	Mailbox mailbox_;
+	alignas(64) std::atomic<std::size_t> pending_;
+};
+
+} // namespace stel
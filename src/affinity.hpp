@@ -0,0 +1,67 @@
+#pragma once
+
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace stel {
+
+// Number of CPUs the OS reports, never 0
+inline unsigned hardware_cpus() noexcept {
+	const unsigned n = std::thread::hardware_concurrency();
+	return n == 0 ? 1 : n;
+}
+
+// Pin the calling thread to a single CPU (wrapped modulo hardware_cpus()).
+// Returns false where pinning isn't supported or the call was refused,
+// callers are expected to carry on unpinned.
+inline bool pin_current_thread(unsigned cpu) noexcept {
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % hardware_cpus(), &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+// Pins the calling thread for the guard's lifetime, then puts back the affinity
+// mask it had before. For threads that are reused afterwards (a benchmark's main
+// thread) - anything they spawn later would otherwise inherit the single CPU.
+// Must be destroyed on the thread that created it.
+class scoped_pin {
+public:
+	explicit scoped_pin(unsigned cpu) noexcept {
+#if defined(__linux__)
+		saved_ok_ = pthread_getaffinity_np(pthread_self(), sizeof(saved_), &saved_) == 0;
+#endif
+		pinned_ = pin_current_thread(cpu);
+	}
+
+	~scoped_pin() {
+#if defined(__linux__)
+		if (pinned_ && saved_ok_) {
+			pthread_setaffinity_np(pthread_self(), sizeof(saved_), &saved_);
+		}
+#endif
+	}
+
+	scoped_pin(const scoped_pin&) = delete;
+	scoped_pin& operator =(const scoped_pin&) = delete;
+
+	bool pinned() const noexcept { return pinned_; }
+
+private:
+#if defined(__linux__)
+	cpu_set_t saved_;
+	bool saved_ok_ = false;
+#endif
+	bool pinned_ = false;
+};
+
+} // namespace stel
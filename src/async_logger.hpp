@@ -0,0 +1,368 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Compact binary log record - exactly one cache line.
+// The hot thread only stores the format pointer and the raw argument bits,
+// all formatting happens on the background thread.
+struct log_record {
+	static constexpr std::size_t max_args = 6;
+
+	enum class arg_type : std::uint8_t { i64, u64, f64, chr, cstr, ptr };
+
+	const char* fmt;
+	std::uint8_t nargs;
+	arg_type types[max_args];
+	std::uint64_t args[max_args];
+};
+static_assert(sizeof(log_record) == 64, "log_record should fit a cache line");
+
+// Asynchronous logger
+//
+// Every thread that logs gets its own lock_free_spsc_queue<log_record> (created on
+// its first log() call), so the hot path is a single SPSC push - no locks, no shared
+// cache lines between logging threads. A background thread round-robins over the
+// rings, formats the records and writes them with batched writev() calls.
+//
+// Format strings use "{}" as placeholder. The format string and any const char*
+// argument are stored as pointers, so they must outlive the logger (string
+// literals, static tables). Lines from different threads are not ordered.
+//
+// When a thread's ring is full the record is dropped and counted - logging never
+// blocks the caller. Same if the ring can't be allocated on a thread's first log()
+// (out of memory): log() is noexcept and reports it by returning false.
+class async_logger {
+public:
+	using ring_type = lock_free_spsc_queue<log_record>;
+
+	// fd is not owned. ring_capacity is per thread and must be a power of 2.
+	explicit async_logger(int fd,
+			std::size_t ring_capacity = 4096,
+			std::chrono::microseconds idle_sleep = std::chrono::microseconds(100))
+		: fd_(fd)
+		, ring_capacity_(ring_capacity)
+		, idle_sleep_(idle_sleep)
+		, id_(next_id_().fetch_add(1, std::memory_order_relaxed) + 1)
+		, ring_count_(0)
+		, dropped_(0)
+		, written_(0)
+		, flush_req_(0)
+		, flush_done_(0)
+		, stop_(false)
+	{
+		writer_ = std::thread([this] { run_(); });
+	}
+
+	async_logger(const async_logger&) = delete;
+	async_logger& operator =(const async_logger&) = delete;
+	async_logger(async_logger&&) = delete;
+	async_logger& operator =(async_logger&&) = delete;
+
+	// Writes out everything still queued. No thread may be logging anymore.
+	~async_logger() {
+		stop_.store(true, std::memory_order_release);
+		if (writer_.joinable()) {
+			writer_.join();
+		}
+	}
+
+	template <typename... Args>
+	bool log(const char* fmt, Args... args) noexcept {
+		static_assert(sizeof...(Args) <= log_record::max_args, "too many log arguments");
+
+		log_record r;
+		r.fmt = fmt;
+		r.nargs = static_cast<std::uint8_t>(sizeof...(Args));
+		std::size_t i = 0;
+		(encode_(r, i++, args), ...);
+
+		ring_type* ring = local_ring_();
+		if (!ring || !ring->try_push(r)) {
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		return true;
+	}
+
+	// Blocks until everything logged before the call (by any thread) has been written.
+	void flush() {
+		const std::uint64_t target = flush_req_.fetch_add(1, std::memory_order_seq_cst) + 1;
+		std::uint64_t done = flush_done_.load(std::memory_order_acquire);
+		while (done < target) {
+			flush_done_.wait(done, std::memory_order_acquire);
+			done = flush_done_.load(std::memory_order_acquire);
+		}
+	}
+
+	std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+	std::uint64_t written() const noexcept { return written_.load(std::memory_order_relaxed); }
+
+private:
+	// Formatted output is collected in chunks, one writev() covers all of them
+	static constexpr std::size_t chunk_size = 16 * 1024;
+	static constexpr std::size_t max_chunks = 16;
+	// Longest single formatted line, the rest is truncated
+	static constexpr std::size_t max_line = 1024;
+	// Records taken from one ring before moving to the next one
+	static constexpr std::size_t batch = 256;
+
+	struct tls_ring {
+		std::uint64_t owner = 0;
+		ring_type* ring = nullptr;
+	};
+
+	static std::atomic<std::uint64_t>& next_id_() {
+		static std::atomic<std::uint64_t> id{0};
+		return id;
+	}
+
+	// The ring of the calling thread. Loggers are told apart by id, not by address,
+	// so a new logger constructed where an old one lived doesn't inherit its rings.
+	// nullptr if the ring couldn't be allocated (the next call tries again).
+	ring_type* local_ring_() noexcept {
+		static thread_local tls_ring tls;
+		if (tls.owner != id_) [[unlikely]] {
+			tls.ring = register_ring_();
+			if (!tls.ring) return nullptr;
+			tls.owner = id_;
+		}
+		return tls.ring;
+	}
+
+	// Slow path: a thread that alternates between loggers finds its old ring again.
+	// Allocates on a thread's first call - log() is noexcept, so failure is nullptr.
+	ring_type* register_ring_() noexcept {
+		const auto self = std::this_thread::get_id();
+		try {
+			std::lock_guard lock(rings_mutex_);
+			for (std::size_t i = 0; i < owners_.size(); ++i) {
+				if (owners_[i] == self) return rings_[i].get();
+			}
+			// Everything that can throw first, so rings_ and owners_ stay in step
+			rings_.reserve(rings_.size() + 1);
+			owners_.reserve(owners_.size() + 1);
+			auto ring = std::make_unique<ring_type>(ring_capacity_);
+			rings_.push_back(std::move(ring));
+			owners_.push_back(self);
+			ring_count_.store(rings_.size(), std::memory_order_release);
+			return rings_.back().get();
+		} catch (...) {
+			return nullptr;
+		}
+	}
+
+	template <typename A>
+	static void encode_(log_record& r, std::size_t i, A a) noexcept {
+		using arg_type = log_record::arg_type;
+		if constexpr (std::is_same_v<A, char>) {
+			r.types[i] = arg_type::chr;
+			r.args[i] = static_cast<unsigned char>(a);
+		} else if constexpr (std::is_same_v<A, bool>) {
+			r.types[i] = arg_type::u64;
+			r.args[i] = a ? 1 : 0;
+		} else if constexpr (std::is_integral_v<A> && std::is_signed_v<A>) {
+			r.types[i] = arg_type::i64;
+			r.args[i] = static_cast<std::uint64_t>(static_cast<std::int64_t>(a));
+		} else if constexpr (std::is_integral_v<A>) {
+			r.types[i] = arg_type::u64;
+			r.args[i] = static_cast<std::uint64_t>(a);
+		} else if constexpr (std::is_floating_point_v<A>) {
+			r.types[i] = arg_type::f64;
+			r.args[i] = std::bit_cast<std::uint64_t>(static_cast<double>(a));
+		} else if constexpr (std::is_same_v<A, const char*> || std::is_same_v<A, char*>) {
+			r.types[i] = arg_type::cstr;
+			r.args[i] = reinterpret_cast<std::uintptr_t>(a);
+		} else if constexpr (std::is_pointer_v<A>) {
+			r.types[i] = arg_type::ptr;
+			r.args[i] = reinterpret_cast<std::uintptr_t>(a);
+		} else {
+			static_assert(std::is_pointer_v<A>, "unsupported log argument type");
+		}
+	}
+
+	// Appends the formatted record plus '\n' to out, returns the number of bytes used
+	static std::size_t format_(const log_record& r, char* out) noexcept {
+		using arg_type = log_record::arg_type;
+		char* p = out;
+		char* const end = out + max_line - 1; // keep room for '\n'
+		std::size_t next = 0;
+
+		for (const char* f = r.fmt; *f && p < end; ++f) {
+			if (f[0] != '{' || f[1] != '}' || next >= r.nargs) {
+				*p++ = *f;
+				continue;
+			}
+			++f;
+			const std::uint64_t v = r.args[next];
+			switch (r.types[next++]) {
+			case arg_type::i64:
+				p = std::to_chars(p, end, static_cast<std::int64_t>(v)).ptr;
+				break;
+			case arg_type::u64:
+				p = std::to_chars(p, end, v).ptr;
+				break;
+			case arg_type::f64:
+				p = std::to_chars(p, end, std::bit_cast<double>(v)).ptr;
+				break;
+			case arg_type::chr:
+				*p++ = static_cast<char>(v);
+				break;
+			case arg_type::cstr: {
+				const char* s = reinterpret_cast<const char*>(static_cast<std::uintptr_t>(v));
+				if (!s) s = "(null)";
+				while (*s && p < end) *p++ = *s++;
+				break;
+			}
+			case arg_type::ptr:
+				if (end - p > 2) {
+					*p++ = '0';
+					*p++ = 'x';
+					p = std::to_chars(p, end, v, 16).ptr;
+				}
+				break;
+			}
+		}
+		*p++ = '\n';
+		return static_cast<std::size_t>(p - out);
+	}
+
+	void run_() {
+		std::vector<ring_type*> rings;
+		std::vector<std::unique_ptr<char[]>> chunks;
+		std::array<iovec, max_chunks> iov{};
+		for (std::size_t i = 0; i < max_chunks; ++i) {
+			chunks.push_back(std::make_unique<char[]>(chunk_size));
+		}
+
+		std::size_t chunk = 0;
+		std::size_t used = 0;
+		std::uint64_t lines = 0;
+
+		auto write_out = [&] {
+			std::size_t n = 0;
+			for (std::size_t c = 0; c <= chunk && c < max_chunks; ++c) {
+				const std::size_t len = (c == chunk) ? used : iov[c].iov_len;
+				if (len == 0) continue;
+				iov[n].iov_base = chunks[c].get();
+				iov[n].iov_len = len;
+				++n;
+			}
+			write_all_(iov.data(), n);
+			written_.fetch_add(lines, std::memory_order_relaxed);
+			chunk = 0;
+			used = 0;
+			lines = 0;
+		};
+
+		for (;;) {
+			// Read both before the pass: everything logged before them is visible now
+			const bool stopping = stop_.load(std::memory_order_acquire);
+			const std::uint64_t flush_req = flush_req_.load(std::memory_order_seq_cst);
+
+			if (ring_count_.load(std::memory_order_acquire) != rings.size()) {
+				std::lock_guard lock(rings_mutex_);
+				rings.clear();
+				for (auto& r : rings_) rings.push_back(r.get());
+			}
+
+			// Keep passing over the rings until a pass finds nothing
+			bool any = false;
+			for (bool progress = true; progress; ) {
+				progress = false;
+				for (ring_type* ring : rings) {
+					log_record r;
+					for (std::size_t k = 0; k < batch && ring->try_pop(r); ++k) {
+						if (chunk_size - used < max_line) {
+							iov[chunk].iov_len = used;
+							if (++chunk == max_chunks) {
+								--chunk; // write_out() expects the current chunk
+								write_out();
+							} else {
+								used = 0;
+							}
+						}
+						used += format_(r, chunks[chunk].get() + used);
+						++lines;
+						progress = true;
+					}
+				}
+				any |= progress;
+			}
+
+			if (lines != 0) {
+				write_out();
+			}
+
+			if (flush_done_.load(std::memory_order_relaxed) < flush_req) {
+				flush_done_.store(flush_req, std::memory_order_release);
+				flush_done_.notify_all();
+			}
+
+			if (stopping) break;
+			if (!any) {
+				std::this_thread::sleep_for(idle_sleep_);
+			}
+		}
+	}
+
+	void write_all_(iovec* iov, std::size_t n) noexcept {
+		while (n > 0) {
+			const int cnt = static_cast<int>(n < IOV_MAX ? n : IOV_MAX);
+			const ssize_t w = ::writev(fd_, iov, cnt);
+			if (w < 0) {
+				if (errno == EINTR) continue;
+				return; // nowhere to report it, the logger is the error channel
+			}
+			// Skip what was written, partial writes resume mid-iovec
+			std::size_t left = static_cast<std::size_t>(w);
+			while (n > 0 && left >= iov->iov_len) {
+				left -= iov->iov_len;
+				++iov;
+				--n;
+			}
+			if (n > 0) {
+				iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+				iov->iov_len -= left;
+			}
+		}
+	}
+
+	const int fd_;
+	const std::size_t ring_capacity_;
+	const std::chrono::microseconds idle_sleep_;
+	const std::uint64_t id_;
+
+	std::mutex rings_mutex_;
+	std::vector<std::unique_ptr<ring_type>> rings_;
+	std::vector<std::thread::id> owners_;
+	std::atomic<std::size_t> ring_count_;
+
+	std::atomic<std::uint64_t> dropped_;
+	std::atomic<std::uint64_t> written_;
+	std::atomic<std::uint64_t> flush_req_;
+	std::atomic<std::uint64_t> flush_done_;
+	std::atomic<bool> stop_;
+
+	std::thread writer_;
+};
+
+} // namespace stel
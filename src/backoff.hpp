@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace stel {
+
+// One spin-wait hint: tells the core we're in a spin loop so it can back off the
+// memory pipeline (and give cycles to the SMT sibling). Not a sleep.
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield" ::: "memory");
+#elif defined(__powerpc__) || defined(__ppc__) || defined(__PPC__)
+	asm volatile("or 27,27,27" ::: "memory");
+#else
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// How a backoff escalates. Defaults come from backoff_tuning::calibrated().
+struct backoff_tuning {
+	unsigned max_pauses = 64;   // cap of the exponential cpu_relax() phase, per step
+	unsigned spin_steps = 10;   // steps spent in cpu_relax(): 1, 2, 4 ... max_pauses
+	unsigned yield_steps = 16;  // then this many std::this_thread::yield()
+
+	// Measured once per process: how long cpu_relax() takes here. On Skylake and
+	// later a pause is ~140 cycles, on older x86 ~10, on ARM `yield` is nearly free,
+	// so a fixed pause count means wildly different wait times. max_pauses is sized
+	// so one step stays around a microsecond.
+	static const backoff_tuning& calibrated() {
+		static const backoff_tuning t = calibrate_();
+		return t;
+	}
+
+private:
+	static backoff_tuning calibrate_() {
+		using clock = std::chrono::steady_clock;
+		constexpr int rounds = 2000;
+		const auto start = clock::now();
+		for (int i = 0; i < rounds; ++i) cpu_relax();
+		const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+		const double per_pause = std::max(ns / rounds, 0.5);
+
+		backoff_tuning t;
+		unsigned pauses = static_cast<unsigned>(1000.0 / per_pause);
+		pauses = std::clamp(pauses, 4u, 1024u);
+		t.max_pauses = 1;
+		t.spin_steps = 0;
+		while (t.max_pauses * 2 <= pauses) {
+			t.max_pauses *= 2;
+			++t.spin_steps;
+		}
+		t.spin_steps += 4; // a few steps at the cap before yielding
+		return t;
+	}
+};
+
+// Escalating wait for spin loops: exponential cpu_relax(), then yield, then
+// (optionally) parking on an atomic.
+//
+//	stel::backoff b;
+//	while (!q.try_pop(v)) b.pause();
+//
+// After spin_steps + yield_steps calls exhausted() turns true - loops that have a
+// real sleep (a semaphore, a futex) use that as the point to go to sleep. pause()
+// itself never sleeps, it keeps yielding. wait(a, old) parks on a (futex on Linux)
+// once exhausted, which only works if whoever changes a also calls notify.
+class backoff {
+public:
+	backoff() noexcept : backoff(backoff_tuning::calibrated()) { }
+	explicit backoff(const backoff_tuning& t) noexcept : t_(t) { }
+
+	void pause() noexcept {
+		if (step_ < t_.spin_steps) {
+			const unsigned n = std::min(1u << std::min(step_, 31u), t_.max_pauses);
+			for (unsigned i = 0; i < n; ++i) cpu_relax();
+		} else {
+			std::this_thread::yield();
+		}
+		if (step_ < t_.spin_steps + t_.yield_steps) ++step_;
+	}
+
+	// pause(), or block in a.wait(old) once spinning and yielding are used up
+	template <typename T>
+	void wait(const std::atomic<T>& a, T old) noexcept {
+		if (!exhausted()) {
+			pause();
+		} else {
+			a.wait(old, std::memory_order_acquire);
+		}
+	}
+
+	bool exhausted() const noexcept { return step_ >= t_.spin_steps + t_.yield_steps; }
+	// Call after making progress so the next wait starts with short pauses again
+	void reset() noexcept { step_ = 0; }
+
+private:
+	backoff_tuning t_;
+	unsigned step_ = 0;
+};
+
+} // namespace stel
@@ -6,17 +6,28 @@
 #include <functional>
 #include <semaphore>
 #include <limits>
+#include <cstdint>
 
+#include "backoff.hpp"
 #include "lock_free_mpmc_bounded.hpp"
 
 namespace stel {
 
 // This is not typical thread pool, it's a specialized pool for high-throughput scenarios.
+//
+// Wakeups are throttled Go-scheduler style: at most max_spinners workers are
+// "spinning" (awake, polling the queue for a while before going to sleep).
+// submit() only wakes a sleeper when nobody is spinning, so a burst of submits
+// costs one wakeup instead of one per task. When a spinner finds work and it was
+// the last one spinning, it wakes a replacement, so the pool ramps up one worker
+// at a time while work keeps coming.
 class bounded_mpmc_pool {
 public:
 	bounded_mpmc_pool(std::size_t workers, 
-				std::size_t queue_capacity) 
-		: q_(queue_capacity), stop_(false), sem_(0) 
+				std::size_t queue_capacity,
+				std::size_t max_spinners = 2) 
+		: q_(queue_capacity), stop_(false), accepting_(true), pending_(0)
+		, max_spinners_(max_spinners == 0 ? 1 : max_spinners), spinning_(0), wakeups_(0), sem_(0) 
 	{ 
 		workers_.reserve(workers);
 		for (std::size_t i = 0; i < workers; ++i) {
@@ -31,17 +42,42 @@ public:
 	// "caller runs" strategy. 
 	// However, it can lead to unbounded stack growth if a 
 	// submitted task also tries to submit to a full queue.
+	//
+	// Returns false once drain() or shutdown() has started - the task is rejected.
+	// true means the task was queued (or run by the caller), not that it will run:
+	// a shutdown() racing with this call may still destroy it unrun, like any
+	// other task it finds in the queue.
 	template <typename F>
 	bool submit(F&& f) {
 		Task t(std::forward<F>(f));
 		if (!t) return false;
 
+		// Count the task before looking at accepting_. drain() does the opposite
+		// (clears accepting_, then reads pending_), so with seq_cst on both sides
+		// either we see the pool closing or drain() sees our task and waits for it.
+		pending_.fetch_add(1, std::memory_order_seq_cst);
+		if (!accepting_.load(std::memory_order_seq_cst)) {
+			finish_one_();
+			return false;
+		}
+
 		// Fast path: try to enqueue
 		if (q_.try_enqueue(t)) {
-			sem_.release(); // Signal "work available"
+			// shutdown() may have passed its accepting_ check and already swept the
+			// queue; then nobody would ever run or count this task. Same Dekker
+			// pairing as above: either its sweep sees our task or we see stop_.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (stop_.load(std::memory_order_relaxed)) {
+				discard_queued_();
+				return true; // queued, then dropped by the shutdown - see above
+			}
+			wake_(); // Signal "work available" - only if nobody is already looking
 			return true;
 		}
 
+		// Not queued, so it doesn't count as pending work
+		finish_one_();
+
 		// Queue full policy - both are bad, second is worse
 		// caller-runs.
 		t();
@@ -55,7 +91,41 @@ public:
 		// return true;
 	}
 
+	// Block until every queued task has run and all workers are idle.
+	// Tasks submitted concurrently may or may not be waited for.
+	// Don't call it from inside a task - it would wait for itself.
+	void wait_idle() const {
+		std::size_t n = pending_.load(std::memory_order_acquire);
+		while (n != 0) {
+			pending_.wait(n, std::memory_order_acquire);
+			n = pending_.load(std::memory_order_acquire);
+		}
+	}
+
+	// Graceful shutdown: reject new tasks, run everything already queued,
+	// then stop and join the workers.
+	void drain() {
+		accepting_.store(false, std::memory_order_seq_cst);
+		wait_idle();
+		shutdown();
+	}
+
+	// Tasks queued or running right now (cheap, racy - for monitoring)
+	std::size_t pending() const noexcept {
+		return pending_.load(std::memory_order_relaxed);
+	}
+
+	// Number of sleeping workers woken by submit() (or by a spinner handing over).
+	// Divide by tasks submitted to get wakeups per task.
+	std::uint64_t wakeups() const noexcept {
+		return wakeups_.load(std::memory_order_relaxed);
+	}
+
+	// Hard stop: workers exit as soon as they observe stop_, tasks still
+	// in the queue are destroyed without running. Use drain() to finish them.
 	void shutdown() {
+		accepting_.store(false, std::memory_order_seq_cst);
+
 		bool expected = false;
 		if (!stop_.compare_exchange_strong(expected, true, 
 					std::memory_order_acq_rel)) {
@@ -72,34 +142,124 @@ public:
 				worker.join();
 			}
 		}
+
+		// Whatever is left in the queue will never run. Drop it and uncount exactly
+		// those tasks - a store of 0 would race with a submit() that has counted its
+		// task but not yet uncounted it, and wrap pending_.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		discard_queued_();
 	}
 
 private:
 	using Task = std::function<void()>;
 
 	void worker_loop() {
+		// A worker that was woken up has already been counted in spinning_ by wake_()
+		bool spinning = false;
+		Task task;
+
 		for (;;) {
-			sem_.acquire(); // sleep until someone releases work or shutdown
 			if (stop_.load(std::memory_order_acquire)) break;
 
-			Task task;
-			// Drain one task, if token was released, there should be one task
-			while (!q_.try_dequeue(task)) {
-				// Rare races: another worker might have grabbed it.
-				// Backoff a tiny bit then retry or bail if stopping.
-				if (stop_.load(std::memory_order_relaxed)) return;
-				std::this_thread::yield();
+			if (q_.try_dequeue(task)) {
+				if (spinning) {
+					spinning = false;
+					// Last spinner found work: more may follow, hand the spinning role over
+					if (spinning_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+						wake_();
+					}
+				}
+				run_(task);
+				continue;
 			}
-			if (!task) {
-				// Should never happen! If it does, queue handed us an empty slot
-				std::terminate();
+
+			if (!spinning) {
+				spinning = try_start_spinning_();
+			}
+
+			if (spinning) {
+				// Poll with backoff, go to sleep once it's exhausted
+				bool found = false;
+				for (backoff b; !b.exhausted(); b.pause()) {
+					if (stop_.load(std::memory_order_relaxed)) return;
+					if (!q_.empty_hint()) {
+						found = true;
+						break;
+					}
+				}
+				if (found) continue; // dequeue at the top of the loop
+
+				spinning = false;
+				spinning_.fetch_sub(1, std::memory_order_seq_cst);
+				// Pairs with the fence in wake_(): either submit() saw us spinning
+				// and skipped the wakeup, or we see its task here.
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (!q_.empty_hint()) continue;
+			}
+
+			sem_.acquire(); // sleep until someone releases work or shutdown
+			spinning = true;
+		}
+	}
+
+	void run_(Task& task) {
+		if (!task) {
+			// Should never happen! If it does, queue handed us an empty slot
+			std::terminate();
+		}
+		task();
+		task = nullptr;
+		finish_one_();
+	}
+
+	bool try_start_spinning_() {
+		std::size_t n = spinning_.load(std::memory_order_relaxed);
+		while (n < max_spinners_) {
+			if (spinning_.compare_exchange_weak(n, n + 1, std::memory_order_seq_cst)) {
+				return true;
 			}
-			task();
+		}
+		return false;
+	}
+
+	// Wake one sleeper unless a worker is already spinning. The woken worker is
+	// counted as spinning right here, so concurrent submits don't wake more.
+	void wake_() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (spinning_.load(std::memory_order_relaxed) != 0) return;
+		std::size_t expected = 0;
+		if (!spinning_.compare_exchange_strong(expected, 1, std::memory_order_seq_cst)) return;
+		wakeups_.fetch_add(1, std::memory_order_relaxed);
+		sem_.release();
+	}
+
+	// Destroy queued tasks without running them (after shutdown)
+	void discard_queued_() {
+		Task task;
+		while (q_.try_dequeue(task)) {
+			task = nullptr;
+			finish_one_();
+		}
+	}
+
+	void finish_one_() {
+		// Only the transition to zero can release wait_idle()
+		if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			pending_.notify_all();
 		}
 	}
 	
 	mpmc_bounded_queue<Task> q_;
 	std::atomic<bool> stop_;
+	std::atomic<bool> accepting_;
+	// Tasks accepted into the queue and not finished yet (queued + running)
+	std::atomic<std::size_t> pending_;
+
+	const std::size_t max_spinners_;
+	// Workers polling the queue (plus ones woken and about to start polling)
+	std::atomic<std::size_t> spinning_;
+	std::atomic<std::uint64_t> wakeups_;
+
 	std::counting_semaphore<std::numeric_limits<int>::max()> sem_;
 	std::vector<std::thread> workers_;
 };
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#include "lock_free_spsc.hpp"
+
+// B-Queue style Single Producer - Single Consumer ring buffer
+// (Wang et al., "B-Queue: Efficient and Practical Queuing for Fast Core-to-Core
+// Communication").
+//
+// lock_free_spsc_queue keeps head_/tail_ in shared cache lines and each side reads
+// the other's index on every call, so the two lines ping-pong between the cores.
+// Here there are no shared indices at all: every slot carries a `full` flag, and
+// each side only knows its own position plus how far ahead it has proven the
+// ring to be usable.
+//
+//	* producer: when it runs out of proven-free slots it probes the slot `batch`
+//	  ahead. The consumer frees slots in order, so if that one is empty, so is
+//	  everything before it - the next `batch` pushes need no checks beyond writing.
+//	* consumer: same thing looking for full slots. If the slot `batch` ahead isn't
+//	  full yet it backtracks, halving the distance, so a partially filled batch is
+//	  still consumed instead of waiting for the producer to fill it.
+//
+// The producer backtracks the same way, so the whole capacity is usable.
+// Shared cache lines are only touched at batch boundaries, and then only the
+// slot lines that carry data anyway.
+//
+// Capacity is exactly `capacity` (no N - 1 slot), which must be a power of two.
+template <typename T>
+class bqueue_spsc_queue {
+public:
+	static_assert(std::is_move_constructible_v<T>, "T must be move constructible");
+
+	explicit bqueue_spsc_queue(std::size_t capacity, std::size_t batch = 64)
+		: cap_(capacity)
+		, mask_(capacity - 1)
+		, batch_(batch == 0 ? 1 : (batch > capacity / 2 ? capacity / 2 : batch))
+		, slots_(static_cast<slot*>(::operator new[](cap_ * sizeof(slot), std::align_val_t(alignof(slot)))))
+	{
+		assert(cap_ >= 2 && (cap_ & (cap_ - 1)) == 0);
+		for (std::size_t i = 0; i < cap_; ++i) {
+			new (&slots_[i]) slot();
+		}
+	}
+
+	~bqueue_spsc_queue() {
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			while (try_pop()) ;
+		}
+		for (std::size_t i = 0; i < cap_; ++i) {
+			slots_[i].~slot();
+		}
+		::operator delete[](slots_, std::align_val_t(alignof(slot)));
+	}
+
+	bqueue_spsc_queue(const bqueue_spsc_queue&) = delete;
+	bqueue_spsc_queue& operator =(const bqueue_spsc_queue&) = delete;
+
+	bool try_push(T value) noexcept (std::is_nothrow_move_constructible_v<T>) {
+		if (p_.pos == p_.limit && !probe_free_()) {
+			return false; // queue is full
+		}
+		slot& s = slots_[p_.pos & mask_];
+		new (s.ptr()) T(std::move(value));
+		s.full.store(true, std::memory_order_release);
+		++p_.pos;
+		return true;
+	}
+
+	bool try_pop(T& value) noexcept (std::is_nothrow_move_assignable_v<T>) {
+		if (c_.pos == c_.limit && !probe_full_()) {
+			return false; // queue is empty
+		}
+		slot& s = slots_[c_.pos & mask_];
+		value = std::move(*s.ptr());
+		s.ptr()->~T();
+		s.full.store(false, std::memory_order_release);
+		++c_.pos;
+		return true;
+	}
+
+	std::optional<T> try_pop() noexcept (std::is_nothrow_move_constructible_v<T>) {
+		if (c_.pos == c_.limit && !probe_full_()) {
+			return std::nullopt;
+		}
+		slot& s = slots_[c_.pos & mask_];
+		std::optional<T> value(std::move(*s.ptr()));
+		s.ptr()->~T();
+		s.full.store(false, std::memory_order_release);
+		++c_.pos;
+		return value;
+	}
+
+	// Consumer only
+	bool empty() const noexcept {
+		return c_.pos == c_.limit && !slots_[c_.pos & mask_].full.load(std::memory_order_acquire);
+	}
+
+	std::size_t capacity() const noexcept { return cap_; }
+	std::size_t batch() const noexcept { return batch_; }
+
+private:
+	struct slot {
+		std::atomic<bool> full{false};
+		alignas(T) unsigned char storage[sizeof(T)];
+		T* ptr() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+	};
+
+	// One side's private view: next slot to use, and the first slot not yet proven usable
+	struct alignas(hardware_destructive_interference_size) cursor {
+		std::size_t pos = 0;
+		std::size_t limit = 0;
+	};
+
+	// Find free slots ahead of the producer, largest proven batch first.
+	// Slot pos + d - 1 free means the consumer is past it, so [pos, pos + d) is free.
+	bool probe_free_() noexcept {
+		for (std::size_t d = batch_; d > 0; d /= 2) {
+			if (!slots_[(p_.pos + d - 1) & mask_].full.load(std::memory_order_acquire)) {
+				p_.limit = p_.pos + d;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Same for the consumer. Slot pos + d - 1 full means [pos, pos + d) is published,
+	// and the acquire on its flag makes all of their contents visible.
+	bool probe_full_() noexcept {
+		for (std::size_t d = batch_; d > 0; d /= 2) {
+			if (slots_[(c_.pos + d - 1) & mask_].full.load(std::memory_order_acquire)) {
+				c_.limit = c_.pos + d;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const std::size_t cap_;
+	const std::size_t mask_;
+	const std::size_t batch_;
+	slot* const slots_;
+
+	cursor p_; // producer only
+	cursor c_; // consumer only
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Epoch-based memory reclamation (EBR) for node-based lock-free structures.
+//
+// A thread pins the domain before it touches shared nodes and unpins afterwards.
+// A node unlinked by some thread is retired, not deleted: it goes into that
+// thread's bag for the current global epoch. The global epoch only moves from e to
+// e + 1 once every pinned thread has been seen in e, so when the epoch reaches
+// e + 2 no thread can still hold a pointer read in e, and the e bag is freed.
+//
+//	stel::epoch_domain dom;
+//	auto h = dom.register_thread();   // once per thread
+//	{
+//		auto g = h.pin();
+//		node* n = pop_somehow();      // reads shared pointers
+//		h.retire(n);                  // deleted two epochs later
+//	}
+//
+// Costs: pin/unpin is a store and a fence on a thread-private cache line. Retire
+// is a full fence plus a push_back, so it costs about as much as a pin. Every
+// `scan_every` retires the thread tries to advance the epoch, which reads one word
+// per registered thread - that scan is the only O(threads) part.
+//
+// A pinned thread that never unpins stops reclamation for everyone, memory then just
+// accumulates in the bags. Keep critical sections short.
+class epoch_domain {
+	struct retired {
+		void* ptr;
+		void (*deleter)(void*);
+	};
+
+	struct bag {
+		std::uint64_t epoch = 0;
+		std::vector<retired> items;
+	};
+
+	// Per thread, on its own line. state is 0 when unpinned, (epoch << 1) | 1 when pinned.
+	struct alignas(hardware_destructive_interference_size) record {
+		std::atomic<std::uint64_t> state{0};
+		std::atomic<bool> in_use{false};
+	};
+
+	static void free_(bag& b) noexcept {
+		for (const retired& r : b.items) r.deleter(r.ptr);
+		b.items.clear();
+	}
+
+public:
+	class thread_handle;
+
+	// Pinned section, unpins on destruction. Nesting is fine.
+	class guard {
+	public:
+		guard(const guard&) = delete;
+		guard& operator =(const guard&) = delete;
+		~guard() { h_.unpin_(); }
+
+	private:
+		friend class thread_handle;
+		explicit guard(thread_handle& h) : h_(h) { h_.pin_(); }
+		thread_handle& h_;
+	};
+
+	// A registered thread. Not thread safe and not movable - create one per thread
+	// (guaranteed elision lets `auto h = dom.register_thread();` work) and keep it
+	// for the thread's lifetime. It must not outlive the domain.
+	class thread_handle {
+	public:
+		thread_handle(const thread_handle&) = delete;
+		thread_handle& operator =(const thread_handle&) = delete;
+
+		// Whatever can't be freed yet is handed to the domain
+		~thread_handle() {
+			assert(nesting_ == 0 && "thread_handle destroyed while pinned");
+			collect_();
+			for (bag& b : bags_) dom_.adopt_(b);
+			rec_.in_use.store(false, std::memory_order_release);
+		}
+
+		[[nodiscard]] guard pin() { return guard(*this); }
+
+		// p must already be unreachable for threads that pin from now on
+		template <typename T>
+		void retire(T* p) {
+			retire(p, [](void* q) { delete static_cast<T*>(q); });
+		}
+
+		void retire(void* p, void (*deleter)(void*)) {
+			// The unlink of p must be visible before we read the epoch we file it
+			// under, or try_advance() could move two epochs past a reader that still
+			// sees p. Pairs with the fences in pin_() and try_advance(), same as the
+			// fence crossbeam puts in push_bag.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const std::uint64_t e = dom_.epoch_.load(std::memory_order_acquire);
+			bag& b = bags_[e % 3];
+			if (b.epoch != e) {
+				// The slot held epoch e - 3 or older, which is safe by now
+				pending_ -= b.items.size();
+				free_(b);
+				b.epoch = e;
+			}
+			b.items.push_back(retired{p, deleter});
+			++pending_;
+			if (++since_scan_ >= dom_.scan_every_) {
+				since_scan_ = 0;
+				reclaim();
+			}
+		}
+
+		// Try to advance the epoch, then free every bag that is two epochs behind
+		void reclaim() {
+			dom_.try_advance();
+			collect_();
+		}
+
+		// Retired here, not freed yet
+		std::size_t pending() const noexcept { return pending_; }
+
+	private:
+		friend class epoch_domain;
+		friend class guard;
+
+		thread_handle(epoch_domain& dom, record& rec) : dom_(dom), rec_(rec) { }
+
+		void pin_() {
+			if (nesting_++ != 0) return;
+			const std::uint64_t e = dom_.epoch_.load(std::memory_order_relaxed);
+			rec_.state.store((e << 1) | 1, std::memory_order_relaxed);
+			// The announcement must be visible before we read any shared pointer,
+			// and try_advance() must not miss it - StoreLoad, hence a full fence.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+
+		void unpin_() {
+			if (--nesting_ != 0) return;
+			rec_.state.store(0, std::memory_order_release);
+		}
+
+		void collect_() {
+			const std::uint64_t e = dom_.epoch_.load(std::memory_order_acquire);
+			for (bag& b : bags_) {
+				if (!b.items.empty() && b.epoch + 2 <= e) {
+					pending_ -= b.items.size();
+					free_(b);
+				}
+			}
+		}
+
+		epoch_domain& dom_;
+		record& rec_;
+		bag bags_[3];
+		std::size_t pending_ = 0;
+		std::size_t since_scan_ = 0;
+		unsigned nesting_ = 0;
+	};
+
+	// max_threads: how many thread_handles may be alive at once.
+	// scan_every: retires between attempts to advance the epoch.
+	explicit epoch_domain(std::size_t max_threads = 128, std::size_t scan_every = 64)
+		: records_(std::make_unique<record[]>(max_threads))
+		, max_threads_(max_threads)
+		, scan_every_(scan_every == 0 ? 1 : scan_every)
+	{ }
+
+	epoch_domain(const epoch_domain&) = delete;
+	epoch_domain& operator =(const epoch_domain&) = delete;
+
+	// Every thread_handle must be gone. Frees everything still retired.
+	~epoch_domain() {
+		for (bag& b : orphans_) free_(b);
+	}
+
+	// Throws std::length_error when max_threads handles are alive already
+	thread_handle register_thread() {
+		for (std::size_t i = 0; i < max_threads_; ++i) {
+			bool expected = false;
+			if (!records_[i].in_use.load(std::memory_order_relaxed) &&
+					records_[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+				std::size_t hw = high_water_.load(std::memory_order_relaxed);
+				while (hw < i + 1 && !high_water_.compare_exchange_weak(hw, i + 1, std::memory_order_release)) { }
+				return thread_handle(*this, records_[i]);
+			}
+		}
+		throw std::length_error("epoch_domain: too many threads");
+	}
+
+	// Moves the global epoch forward if every pinned thread has caught up with it.
+	// Returns true if the epoch is now past the one observed on entry.
+	bool try_advance() {
+		std::uint64_t e = epoch_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const std::size_t n = high_water_.load(std::memory_order_acquire);
+		for (std::size_t i = 0; i < n; ++i) {
+			const std::uint64_t s = records_[i].state.load(std::memory_order_acquire);
+			if ((s & 1) && (s >> 1) != e) return false;
+		}
+		if (epoch_.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel)) {
+			collect_orphans_(e + 1);
+			return true;
+		}
+		return true; // somebody else advanced it
+	}
+
+	std::uint64_t epoch() const noexcept { return epoch_.load(std::memory_order_relaxed); }
+
+private:
+	void adopt_(bag& b) {
+		if (b.items.empty()) return;
+		std::lock_guard lock(orphans_mutex_);
+		orphans_.push_back(std::move(b));
+		b.items.clear();
+	}
+
+	// Bags left by exited threads. Never blocks the advancing thread.
+	void collect_orphans_(std::uint64_t e) {
+		std::unique_lock lock(orphans_mutex_, std::try_to_lock);
+		if (!lock.owns_lock() || orphans_.empty()) return;
+		for (std::size_t i = 0; i < orphans_.size(); ) {
+			if (orphans_[i].epoch + 2 <= e) {
+				free_(orphans_[i]);
+				orphans_[i] = std::move(orphans_.back());
+				orphans_.pop_back();
+			} else {
+				++i;
+			}
+		}
+	}
+
+	std::unique_ptr<record[]> records_;
+	const std::size_t max_threads_;
+	const std::size_t scan_every_;
+
+	alignas(hardware_destructive_interference_size) std::atomic<std::uint64_t> epoch_{2};
+	alignas(hardware_destructive_interference_size) std::atomic<std::size_t> high_water_{0};
+
+	std::mutex orphans_mutex_;
+	std::vector<bag> orphans_;
+};
+
+} // namespace stel
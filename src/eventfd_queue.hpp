@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "lock_free_mpmc_bounded.hpp"
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Makes a ring waitable from epoll/poll/select.
+//
+// Wraps a lock_free_spsc_queue or mpmc_bounded_queue together with an eventfd. The
+// eventfd is only written when the consumer has *armed* the queue, i.e. declared
+// it is about to block in epoll_wait, and only by the one push that disarms it. While
+// the consumer is busy draining, pushes cost no syscall at all.
+//
+// Consumer loop (fd() registered for EPOLLIN):
+//
+//	on readable:
+//		q.consume_event();
+//		do {
+//			q.drain(handle);
+//		} while (!q.arm());   // arm() fails if items slipped in, drain again
+//
+// Arming is a Dekker handshake: the consumer sets armed_ then re-checks the queue,
+// a producer pushes then checks armed_ (both with seq_cst fences), so either the
+// consumer sees the item or the producer sees the flag and signals.
+template <typename T, typename Queue = lock_free_spsc_queue<T>>
+class eventfd_queue {
+public:
+	explicit eventfd_queue(std::size_t capacity)
+		: q_(capacity)
+		, fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+		, armed_(true) // the consumer starts out waiting
+		, signals_(0)
+	{
+		if (fd_ < 0) {
+			throw std::system_error(errno, std::generic_category(), "eventfd_queue: eventfd");
+		}
+	}
+
+	eventfd_queue(const eventfd_queue&) = delete;
+	eventfd_queue& operator =(const eventfd_queue&) = delete;
+
+	~eventfd_queue() {
+		::close(fd_);
+	}
+
+	int fd() const noexcept { return fd_; }
+
+	bool try_push(T value) {
+		bool ok;
+		if constexpr (requires { q_.try_push(std::move(value)); }) {
+			ok = q_.try_push(std::move(value));
+		} else {
+			ok = q_.try_enqueue(std::move(value));
+		}
+		if (!ok) return false;
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		// Plain load first: the common case (consumer busy) touches nothing shared
+		if (armed_.load(std::memory_order_relaxed) &&
+				armed_.exchange(false, std::memory_order_acq_rel)) {
+			signal_();
+		}
+		return true;
+	}
+
+	bool try_pop(T& value) {
+		if constexpr (requires { q_.try_pop(value); }) {
+			return q_.try_pop(value);
+		} else {
+			return q_.try_dequeue(value);
+		}
+	}
+
+	// Pop until empty, returns how many items were handed to f
+	template <typename F>
+	std::size_t drain(F&& f) {
+		std::size_t n = 0;
+		T value;
+		while (try_pop(value)) {
+			f(value);
+			++n;
+		}
+		return n;
+	}
+
+	// Consumer is about to wait on fd(). Returns false if the queue isn't empty
+	// anymore, in which case the consumer must drain again instead of waiting.
+	bool arm() {
+		armed_.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (empty_()) return true;
+		// Items raced in. If a producer already took the flag it has signalled,
+		// the stale event is cleared by the next consume_event().
+		armed_.store(false, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Reset the eventfd counter after epoll reported it readable
+	void consume_event() noexcept {
+		std::uint64_t v;
+		while (::read(fd_, &v, sizeof(v)) < 0 && errno == EINTR) { }
+	}
+
+	// eventfd writes done by producers so far
+	std::uint64_t signals() const noexcept { return signals_.load(std::memory_order_relaxed); }
+
+	Queue& queue() noexcept { return q_; }
+
+private:
+	bool empty_() const {
+		if constexpr (requires { q_.empty(); }) {
+			return q_.empty();
+		} else {
+			return q_.empty_hint();
+		}
+	}
+
+	void signal_() noexcept {
+		const std::uint64_t one = 1;
+		while (::write(fd_, &one, sizeof(one)) < 0 && errno == EINTR) { }
+		signals_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Queue q_;
+	const int fd_;
+	alignas(64) std::atomic<bool> armed_;
+	alignas(64) std::atomic<std::uint64_t> signals_;
+};
+
+template <typename T>
+using eventfd_spsc_queue = eventfd_queue<T, lock_free_spsc_queue<T>>;
+
+template <typename T>
+using eventfd_mpmc_queue = eventfd_queue<T, mpmc_bounded_queue<T>>;
+
+} // namespace stel
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Many producers, one consumer - without a shared tail.
+//
+// Every producer registers once and gets its own lock_free_spsc_queue, so a push
+// only ever touches that producer's ring. The consumer polls the rings, either
+// round-robin (try_pop/drain) or merged by a key such as a timestamp (try_pop_oldest).
+//
+// A summary bitmap has one bit per ring, set while the ring may hold items. The
+// consumer walks set bits only, so idle producers cost nothing to poll. Producers
+// touch the bitmap only on the empty -> non-empty transition of their ring.
+//
+// Clearing is a Dekker handshake: the consumer clears the bit and re-checks the
+// ring, the producer publishes the item and re-reads its own ring's head (seq_cst
+// on both sides). Only if that shows the consumer had taken everything before
+// the new item does the producer look at the bit, so an item can never sit in a
+// ring whose bit is clear. The fence stays on every push; the shared word doesn't.
+template <typename T>
+class fan_in_channel {
+	using ring_type = lock_free_spsc_queue<T>;
+
+public:
+	// Write end of one ring. Owned by exactly one thread at a time.
+	class producer {
+	public:
+		producer() = default;
+
+		bool try_push(T value) {
+			if (!ring_->try_push(std::move(value))) return false;
+			// Pairs with the fence in settle_(): the item is visible before we look
+			// at head_. If the consumer hasn't caught up to our item, it will see
+			// the item before it can find the ring empty and clear the bit.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (ring_->maybe_size() <= 1) {
+				ch_->mark_(idx_);
+			}
+			return true;
+		}
+
+		std::size_t index() const noexcept { return idx_; }
+		explicit operator bool() const noexcept { return ch_ != nullptr; }
+
+	private:
+		friend class fan_in_channel;
+		producer(fan_in_channel* ch, std::size_t idx)
+			: ch_(ch), ring_(ch->rings_[idx].get()), idx_(idx) { }
+
+		fan_in_channel* ch_ = nullptr;
+		ring_type* ring_ = nullptr;
+		std::size_t idx_ = 0;
+	};
+
+	// ring_capacity must be a power of two (one slot is lost, see lock_free_spsc_queue)
+	fan_in_channel(std::size_t max_producers, std::size_t ring_capacity)
+		: words_((max_producers + 63) / 64)
+		, bits_(new word[words_])
+	{
+		rings_.reserve(max_producers);
+		for (std::size_t i = 0; i < max_producers; ++i) {
+			rings_.push_back(std::make_unique<ring_type>(ring_capacity));
+		}
+	}
+
+	fan_in_channel(const fan_in_channel&) = delete;
+	fan_in_channel& operator =(const fan_in_channel&) = delete;
+
+	// Thread safe. Throws std::length_error once max_producers handles are out.
+	producer register_producer() {
+		const std::size_t idx = registered_.fetch_add(1, std::memory_order_relaxed);
+		if (idx >= rings_.size()) {
+			registered_.fetch_sub(1, std::memory_order_relaxed);
+			throw std::length_error("fan_in_channel: too many producers");
+		}
+		return producer(this, idx);
+	}
+
+	// Consumer side, round-robin: one item from the next non-empty ring after the
+	// one served last, so a busy producer can't starve the others.
+	bool try_pop(T& value) {
+		bool found = false;
+		for_each_marked_(cursor_, [&](std::size_t i) {
+			if (rings_[i]->try_pop(value)) {
+				cursor_ = i + 1;
+				found = true;
+				return true;
+			}
+			return false;
+		});
+		return found;
+	}
+
+	// Consumer side: up to per_ring items from every non-empty ring, handed to f
+	// as T&. Returns the total consumed.
+	template <typename F>
+	std::size_t drain(F&& f, std::size_t per_ring = 64) {
+		std::size_t n = 0;
+		for_each_marked_(0, [&](std::size_t i) {
+			n += rings_[i]->pop_bulk(f, per_ring);
+			return false;
+		});
+		return n;
+	}
+
+	// Consumer side, merged order: pops the ring head with the smallest key(item).
+	// Each ring is FIFO, so with monotonic per-producer keys (timestamps, sequence
+	// numbers) this yields a global order among whatever is visible right now.
+	template <typename Key>
+	bool try_pop_oldest(T& value, Key&& key) {
+		ring_type* best = nullptr;
+		decltype(key(std::declval<const T&>())) best_key{};
+		for_each_marked_(0, [&](std::size_t i) {
+			if (const T* head = rings_[i]->front()) {
+				auto k = key(*head);
+				if (!best || k < best_key) {
+					best = rings_[i].get();
+					best_key = k;
+				}
+			}
+			return false;
+		});
+		return best && best->try_pop(value);
+	}
+
+	std::size_t producers() const noexcept { return registered_.load(std::memory_order_relaxed); }
+	std::size_t max_producers() const noexcept { return rings_.size(); }
+
+private:
+	struct alignas(hardware_destructive_interference_size) word {
+		std::atomic<std::uint64_t> bits{0};
+	};
+
+	// Called by a producer, after its fence, when its ring just went non-empty
+	void mark_(std::size_t idx) {
+		std::atomic<std::uint64_t>& w = bits_[idx / 64].bits;
+		const std::uint64_t mask = std::uint64_t(1) << (idx % 64);
+		if (!(w.load(std::memory_order_relaxed) & mask)) {
+			w.fetch_or(mask, std::memory_order_release);
+		}
+	}
+
+	// Bit for ring idx was set but the ring looked empty: clear it, then look again
+	// in case a producer pushed in between and saw the bit still set.
+	void settle_(std::size_t idx) {
+		std::atomic<std::uint64_t>& w = bits_[idx / 64].bits;
+		const std::uint64_t mask = std::uint64_t(1) << (idx % 64);
+		w.fetch_and(~mask, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!rings_[idx]->empty()) {
+			w.fetch_or(mask, std::memory_order_relaxed);
+		}
+	}
+
+	// Visits marked rings starting at `start` (wrapping), stops when f returns
+	// true. Rings that turn out empty get their bit cleared on the way.
+	template <typename F>
+	void for_each_marked_(std::size_t start, F&& f) {
+		const std::size_t n = rings_.size();
+		if (n == 0) return;
+		if (start >= n) start = 0;
+
+		auto visit_range = [&](std::size_t from, std::size_t to) {
+			for (std::size_t wi = from / 64; wi * 64 < to; ++wi) {
+				std::uint64_t m = bits_[wi].bits.load(std::memory_order_acquire);
+				if (wi == from / 64) m &= ~std::uint64_t(0) << (from % 64);
+				while (m) {
+					const std::size_t i = wi * 64 + static_cast<std::size_t>(std::countr_zero(m));
+					m &= m - 1;
+					if (i >= to) return false;
+					if (rings_[i]->empty()) {
+						settle_(i);
+						continue;
+					}
+					if (f(i)) return true;
+				}
+			}
+			return false;
+		};
+
+		if (!visit_range(start, n) && start != 0) {
+			visit_range(0, start);
+		}
+	}
+
+	std::vector<std::unique_ptr<ring_type>> rings_;
+	const std::size_t words_;
+	std::unique_ptr<word[]> bits_;
+	alignas(hardware_destructive_interference_size) std::atomic<std::size_t> registered_{0};
+	std::size_t cursor_ = 0; // consumer only
+};
+
+} // namespace stel
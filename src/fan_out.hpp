@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+enum class fan_out_policy {
+	round_robin,    // next ring in turn, full rings are skipped
+	least_occupied, // ring with the smallest cached size
+	key_hash,       // ring picked by hash(key): same key, same worker, same order
+};
+
+// One producer, many consumers - without a shared head.
+//
+// The dispatcher owns one lock_free_spsc_queue per worker and routes every push
+// to exactly one of them, so each worker only ever reads its own ring. All push
+// calls must come from the same thread.
+//
+// least_occupied doesn't read every ring's head_ on each push (that's a cache
+// miss per worker). It keeps its own size estimate per ring, bumps it on push and
+// only re-reads the real sizes every `refresh` pushes or when a ring looks full.
+template <typename T>
+class fan_out_dispatcher {
+	using ring_type = lock_free_spsc_queue<T>;
+
+public:
+	struct options {
+		fan_out_policy policy = fan_out_policy::round_robin;
+		std::size_t refresh = 32; // least_occupied: pushes between size refreshes
+	};
+
+	// ring_capacity must be a power of two (one slot is lost, see lock_free_spsc_queue)
+	fan_out_dispatcher(std::size_t workers, std::size_t ring_capacity)
+		: fan_out_dispatcher(workers, ring_capacity, options{}) { }
+
+	fan_out_dispatcher(std::size_t workers, std::size_t ring_capacity, options opt)
+		: opt_(opt)
+		, estimate_(workers, 0)
+		, pushed_(workers, 0)
+	{
+		if (opt_.refresh == 0) opt_.refresh = 1;
+		rings_.reserve(workers);
+		for (std::size_t i = 0; i < workers; ++i) {
+			rings_.push_back(std::make_unique<ring_type>(ring_capacity));
+		}
+	}
+
+	fan_out_dispatcher(const fan_out_dispatcher&) = delete;
+	fan_out_dispatcher& operator =(const fan_out_dispatcher&) = delete;
+
+	// Producer side. key is only looked at by key_hash. Returns false when the
+	// chosen ring is full - for key_hash that is the key's ring, the others never
+	// take its items or per-key order would break. value is only moved from when
+	// the push succeeds, so a failed push leaves it with the caller.
+	bool try_push(T&& value, std::uint64_t key = 0) {
+		switch (opt_.policy) {
+		case fan_out_policy::round_robin:    return push_round_robin_(std::move(value));
+		case fan_out_policy::least_occupied: return push_least_occupied_(std::move(value));
+		case fan_out_policy::key_hash:       return push_to_(ring_for_key(key), std::move(value));
+		}
+		return false;
+	}
+
+	bool try_push(const T& value, std::uint64_t key = 0) {
+		T copy(value);
+		return try_push(std::move(copy), key);
+	}
+
+	// Which worker a key maps to
+	std::size_t ring_for_key(std::uint64_t key) const noexcept {
+		// splitmix64 finalizer, so sequential keys spread out
+		key ^= key >> 30; key *= 0xbf58476d1ce4e5b9ULL;
+		key ^= key >> 27; key *= 0x94d049bb133111ebULL;
+		key ^= key >> 31;
+		return static_cast<std::size_t>(key % rings_.size());
+	}
+
+	// Worker side: worker i reads ring i, and nothing else
+	bool try_pop(std::size_t worker, T& value) { return rings_[worker]->try_pop(value); }
+
+	template <typename F>
+	std::size_t drain(std::size_t worker, F&& f, std::size_t max = 64) {
+		return rings_[worker]->pop_bulk(std::forward<F>(f), max);
+	}
+
+	ring_type& ring(std::size_t worker) noexcept { return *rings_[worker]; }
+	std::size_t workers() const noexcept { return rings_.size(); }
+
+	// Items routed to each worker so far. Producer thread only (or after it's done).
+	const std::vector<std::uint64_t>& pushed() const noexcept { return pushed_; }
+
+private:
+	// Checks full() first so a failed attempt leaves value intact for the next ring
+	bool push_to_(std::size_t i, T&& value) {
+		if (rings_[i]->full()) return false;
+		rings_[i]->try_push(std::move(value));
+		++pushed_[i];
+		++estimate_[i];
+		return true;
+	}
+
+	bool push_round_robin_(T&& value) {
+		const std::size_t n = rings_.size();
+		for (std::size_t k = 0; k < n; ++k) {
+			const std::size_t i = next_;
+			next_ = next_ + 1 == n ? 0 : next_ + 1;
+			if (push_to_(i, std::move(value))) return true;
+		}
+		return false;
+	}
+
+	bool push_least_occupied_(T&& value) {
+		if (++since_refresh_ >= opt_.refresh) {
+			refresh_();
+		}
+		const std::size_t n = rings_.size();
+		const std::size_t cap = rings_.front()->capacity();
+		for (std::size_t attempt = 0; attempt < 2; ++attempt) {
+			std::size_t best = 0;
+			for (std::size_t i = 1; i < n; ++i) {
+				if (estimate_[i] < estimate_[best]) best = i;
+			}
+			if (estimate_[best] < cap && push_to_(best, std::move(value))) return true;
+			// The estimates only grow between refreshes, so "full" may be stale
+			refresh_();
+		}
+		return false;
+	}
+
+	void refresh_() {
+		for (std::size_t i = 0; i < rings_.size(); ++i) {
+			estimate_[i] = rings_[i]->maybe_size();
+		}
+		since_refresh_ = 0;
+	}
+
+	std::vector<std::unique_ptr<ring_type>> rings_;
+	options opt_;
+
+	// producer-only state
+	std::vector<std::size_t> estimate_;
+	std::vector<std::uint64_t> pushed_;
+	std::size_t next_ = 0;
+	std::size_t since_refresh_ = 0;
+};
+
+} // namespace stel
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Single Producer - Single Consumer ring of differently-typed messages.
+//
+// Instead of sizing every slot for the largest alternative (what a
+// lock_free_spsc_queue<std::variant<Ts...>> does), each message takes a record of
+//
+//	[tag:4][size:4][padding up to alignof(U)][U][padding to 8]
+//
+// so an 8-byte message costs 16 bytes, not sizeof(the variant). Records never wrap:
+// if one doesn't fit before the end of the buffer the producer writes a skip record
+// over the rest and starts again at offset 0.
+//
+// The consumer hands each object to a visitor as U&. Dispatch is one indirect call
+// through a table built at compile time for that visitor type, one entry per Ts,
+// which also runs the destructor.
+//
+// head_/tail_ are byte counters that only grow, the producer keeps a cached copy
+// of head_ and only re-reads it when the cache says the ring is full.
+template <typename... Ts>
+class hetero_spsc_ring {
+	static_assert(sizeof...(Ts) > 0, "need at least one message type");
+	static_assert(((alignof(Ts) <= 64) && ...), "alignment above a cache line isn't supported");
+
+	struct header {
+		std::uint32_t tag;
+		std::uint32_t size; // whole record, header and padding included
+	};
+	static constexpr std::uint32_t skip_tag = ~std::uint32_t(0);
+	static constexpr std::size_t record_align = 8;
+
+	template <typename U, std::size_t I = 0>
+	static constexpr std::uint32_t index_of_() {
+		static_assert(I < sizeof...(Ts), "type isn't one of the ring's message types");
+		if constexpr (std::is_same_v<U, std::tuple_element_t<I, std::tuple<Ts...>>>) {
+			return I;
+		} else {
+			return index_of_<U, I + 1>();
+		}
+	}
+
+	static constexpr std::size_t align_up_(std::size_t v, std::size_t a) noexcept { return (v + a - 1) & ~(a - 1); }
+
+	// Byte offset of the payload from the start of a record at buffer offset pos
+	static constexpr std::size_t payload_offset_(std::size_t pos, std::size_t align) noexcept {
+		return align_up_(pos + sizeof(header), align) - pos;
+	}
+
+public:
+	static constexpr std::size_t types = sizeof...(Ts);
+
+	// Tag stored for U, also what a visitor can switch on if it wants to
+	template <typename U>
+	static constexpr std::uint32_t tag_of = index_of_<U>();
+
+	// bytes must be a power of two and leave room for the largest record
+	explicit hetero_spsc_ring(std::size_t bytes)
+		: cap_(bytes)
+		, mask_(bytes - 1)
+		, buffer_(static_cast<std::byte*>(::operator new(bytes, std::align_val_t(64))))
+		, head_(0)
+		, tail_(0)
+	{
+		assert((cap_ & (cap_ - 1)) == 0 && cap_ >= 64);
+	}
+
+	hetero_spsc_ring(const hetero_spsc_ring&) = delete;
+	hetero_spsc_ring& operator =(const hetero_spsc_ring&) = delete;
+
+	~hetero_spsc_ring() {
+		if constexpr (!(std::is_trivially_destructible_v<Ts> && ...)) {
+			auto discard = [](auto&) { };
+			while (try_consume(discard)) ;
+		}
+		::operator delete(buffer_, std::align_val_t(64));
+	}
+
+	// Producer side: construct a U in place. Returns false if there is no room.
+	template <typename U, typename... Args>
+	bool try_emplace(Args&&... args) {
+		constexpr std::uint32_t tag = tag_of<U>;
+		const std::size_t tail = tail_.load(std::memory_order_relaxed);
+		std::size_t pos = tail & mask_;
+
+		std::size_t size = align_up_(payload_offset_(pos, alignof(U)) + sizeof(U), record_align);
+		std::size_t skip = 0;
+		if (pos + size > cap_) {
+			// Doesn't fit before the end: burn the rest, record starts at 0
+			skip = cap_ - pos;
+			pos = 0;
+			size = align_up_(payload_offset_(0, alignof(U)) + sizeof(U), record_align);
+		}
+		if (!reserve_(tail, skip + size)) return false;
+
+		if (skip != 0) {
+			new (buffer_ + (tail & mask_)) header{skip_tag, static_cast<std::uint32_t>(skip)};
+		}
+		std::byte* rec = buffer_ + pos;
+		new (rec + payload_offset_(pos, alignof(U))) U(std::forward<Args>(args)...);
+		new (rec) header{tag, static_cast<std::uint32_t>(size)};
+
+		tail_.store(tail + skip + size, std::memory_order_release);
+		return true;
+	}
+
+	template <typename U>
+	bool try_push(U&& value) {
+		using V = std::remove_cvref_t<U>;
+		return try_emplace<V>(std::forward<U>(value));
+	}
+
+	// Consumer side: hand the oldest message to f (called as f(U&) for its type U)
+	// and destroy it. Returns false if the ring is empty.
+	template <typename F>
+	bool try_consume(F&& f) {
+		return consume_bulk(std::forward<F>(f), 1) != 0;
+	}
+
+	// Up to max messages, freed with a single head_ store. If f throws, the
+	// message it threw on is destroyed and released along with the ones before
+	// it, then the exception propagates; later messages stay queued.
+	template <typename F>
+	std::size_t consume_bulk(F&& f, std::size_t max) {
+		using visitor = std::remove_reference_t<F>;
+		const std::size_t start = head_.load(std::memory_order_relaxed);
+		const std::size_t tail = tail_.load(std::memory_order_acquire);
+
+		std::size_t head = start;
+		std::size_t n = 0;
+		try {
+			while (head != tail && n < max) {
+				const std::size_t pos = head & mask_;
+				const header h = *std::launder(reinterpret_cast<const header*>(buffer_ + pos));
+				head += h.size;
+				if (h.tag == skip_tag) continue;
+
+				std::byte* payload = buffer_ + pos + payload_offset_(pos, alignments_[h.tag]);
+				table_<visitor>[h.tag](payload, f);
+				++n;
+			}
+		} catch (...) {
+			// Everything up to head is destroyed - release it, or the next consume
+			// (or ~ring) would visit and destroy it again
+			head_.store(head, std::memory_order_release);
+			throw;
+		}
+		if (head != start) {
+			head_.store(head, std::memory_order_release);
+		}
+		return n;
+	}
+
+	bool empty() const noexcept {
+		return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+	}
+
+	std::size_t capacity_bytes() const noexcept { return cap_; }
+	// Bytes currently held, records and skips included. Can be stale.
+	std::size_t maybe_used_bytes() const noexcept {
+		return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);
+	}
+
+	// Bytes one U takes in the ring when written at an aligned offset
+	template <typename U>
+	static constexpr std::size_t record_size() noexcept {
+		return align_up_(payload_offset_(0, alignof(U)) + sizeof(U), record_align);
+	}
+
+private:
+	bool reserve_(std::size_t tail, std::size_t need) {
+		if (tail + need - head_cache_ <= cap_) return true;
+		head_cache_ = head_.load(std::memory_order_acquire);
+		return tail + need - head_cache_ <= cap_;
+	}
+
+	template <typename U, typename F>
+	static void invoke_(std::byte* p, F& f) {
+		U* obj = std::launder(reinterpret_cast<U*>(p));
+		// Destroy even if f throws, consume_bulk() releases the record either way
+		struct destroy_on_exit {
+			U* obj;
+			~destroy_on_exit() { obj->~U(); }
+		} d{obj};
+		f(*obj);
+	}
+
+	template <typename F>
+	using handler = void (*)(std::byte*, F&);
+
+	// One entry per message type, indexed by tag
+	template <typename F>
+	static constexpr std::array<handler<F>, types> table_{ &invoke_<Ts, F>... };
+
+	static constexpr std::array<std::size_t, types> alignments_{ alignof(Ts)... };
+
+	const std::size_t cap_;
+	const std::size_t mask_;
+	std::byte* const buffer_;
+
+	alignas(hardware_destructive_interference_size) std::atomic<std::size_t> head_; // read
+	alignas(hardware_destructive_interference_size) std::atomic<std::size_t> tail_; // write
+	std::size_t head_cache_ = 0; // producer only, lives next to tail_
+};
+
+} // namespace stel
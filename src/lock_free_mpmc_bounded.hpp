@@ -8,12 +8,18 @@
 #include <cassert>
 #include <iostream>
 
+#include "prefetch.hpp"
+
 template <typename T>
 class mpmc_bounded_queue {
 public:
-	mpmc_bounded_queue(std::size_t cap) 
+	// prefetch_distance: 0 = off, see lock_free_spsc_queue. Here each producer
+	// prefetches the slot that many tickets past the one it claimed, so with several
+	// producers the slots ahead get warmed by whoever happens to be there.
+	mpmc_bounded_queue(std::size_t cap, std::size_t prefetch_distance = 0) 
 		: capacity_(cap) 
 		, mask_(capacity_ - 1)
+		, prefetch_(prefetch_distance < cap ? prefetch_distance : cap - 1)
 		, slots_(static_cast<Slot*>(::operator new[](capacity_ * sizeof(Slot))))  
 		, head_(0)
 		, tail_(0) 
@@ -52,43 +58,62 @@ public:
 
 
 	// Returns false if queue is full (non-blocking)
+	//
+	// The ticket is only claimed (CAS on tail_) once the slot is known to be free.
+	// A blind fetch_add would burn the ticket on failure and leave a hole in the
+	// sequence that no consumer ever reads, so polling an empty/full queue must not
+	// advance the counters.
 	bool try_enqueue(T value) {
-		std::size_t pos = tail_.fetch_add(1, std::memory_order_acq_rel);
-		Slot& s = slots_[pos & mask_];
-
-		std::size_t seq = s.seq.load(std::memory_order_acquire);
-		auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
-		// If diff < 0  -- slot is full
-		// If diff > 0  -- another publisher hasn't finished publishing yet (rare)
-		if (diff != 0) {
-			// The queue is full
-			return false;
+		std::size_t pos = tail_.load(std::memory_order_relaxed);
+		for (;;) {
+			Slot& s = slots_[pos & mask_];
+			const std::size_t seq = s.seq.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+			// If diff == 0 -- slot is free for this lap, try to claim it
+			// If diff < 0  -- slot still holds last lap's item, the queue is full
+			// If diff > 0  -- another producer claimed pos already, reload
+			if (diff == 0) {
+				if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					if (prefetch_) stel::prefetch_write(&slots_[(pos + prefetch_) & mask_], sizeof(Slot));
+					s.put(std::move(value));
+					s.seq.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+				// CAS failure reloaded pos
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = tail_.load(std::memory_order_relaxed);
+			}
 		}
-
-		s.put(std::move(value));
-		s.seq.store(pos + 1, std::memory_order_release);
-		return true;
 	}
 
 	bool try_dequeue(T& value) {
-		std::size_t pos = head_.fetch_add(1, std::memory_order_acq_rel);
-		Slot& s = slots_[pos & mask_];
-
-		std::size_t seq = s.seq.load(std::memory_order_acquire);
-		auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
-		// if diff < 0  -- not published yet
-		// if diff > 0  -- logically imposible (or indicates wrap we're not expecting)
-		if (diff != 0) {
-			// Slot not ready yet - empty
-			return false;
+		std::size_t pos = head_.load(std::memory_order_relaxed);
+		for (;;) {
+			Slot& s = slots_[pos & mask_];
+			const std::size_t seq = s.seq.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+			// if diff == 0 -- published, try to claim it
+			// if diff < 0  -- not published yet, the queue is empty
+			// if diff > 0  -- another consumer took pos already, reload
+			if (diff == 0) {
+				if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					if (prefetch_) stel::prefetch_read(&slots_[(pos + prefetch_) & mask_], sizeof(Slot));
+					value = std::move(s.remove());
+					s.seq.store(pos + capacity_, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = head_.load(std::memory_order_relaxed);
+			}
 		}
-
-		value = std::move(s.remove());
-		s.seq.store(pos + capacity_, std::memory_order_release);
-		return true;
 	}
 
 	std::size_t capacity() const noexcept { return capacity_; }
+	std::size_t prefetch_distance() const noexcept { return prefetch_; }
 
 	// Get size on fast MPMC isn't free.
 	// We can have 3 options:
@@ -141,6 +166,7 @@ private:
 
 	std::size_t capacity_;
 	std::size_t mask_;
+	std::size_t prefetch_; // in slots, 0 = off
 
 	Slot* slots_;
 
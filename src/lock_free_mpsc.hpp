@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Unbounded lock free Multi Producer - Single Consumer queue (Vyukov's intrusive
+// node queue).
+//
+// Producers only do one exchange on head_ and one store, the consumer never
+// touches head_. Nodes are heap allocated per push, and since only the consumer
+// frees them there's no reclamation problem.
+//
+// One caveat: between a producer's exchange and its link store, the node is
+// not reachable yet, so try_pop can return nothing even though a push "already
+// happened". Callers that count messages separately must be ready to retry.
+template <typename T>
+class lock_free_mpsc_queue {
+public:
+	static_assert(std::is_move_constructible_v<T>, "T must be move constructible");
+
+	lock_free_mpsc_queue()
+		: head_(new node())
+		, tail_(head_.load(std::memory_order_relaxed))
+	{ }
+
+	~lock_free_mpsc_queue() {
+		while (try_pop()) ;
+		delete tail_;
+	}
+
+	lock_free_mpsc_queue(const lock_free_mpsc_queue&) = delete;
+	lock_free_mpsc_queue& operator =(const lock_free_mpsc_queue&) = delete;
+	lock_free_mpsc_queue(lock_free_mpsc_queue&&) = delete;
+	lock_free_mpsc_queue& operator =(lock_free_mpsc_queue&&) = delete;
+
+	// Any thread
+	void push(T value) {
+		node* n = new node(std::move(value));
+		node* prev = head_.exchange(n, std::memory_order_acq_rel);
+		prev->next.store(n, std::memory_order_release);
+	}
+
+	// Consumer only
+	std::optional<T> try_pop() {
+		node* tail = tail_;
+		node* next = tail->next.load(std::memory_order_acquire);
+		if (!next) {
+			return std::nullopt;
+		}
+		// next becomes the new stub, its value moves out
+		std::optional<T> value(std::move(next->value));
+		next->value.reset();
+		tail_ = next;
+		delete tail;
+		return value;
+	}
+
+	// Consumer only, racy against producers like any emptiness check
+	bool empty() const noexcept {
+		return tail_->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	struct node {
+		node() = default;
+		explicit node(T&& v) : value(std::move(v)) { }
+
+		std::atomic<node*> next{nullptr};
+		std::optional<T> value;
+	};
+
+	static constexpr std::size_t alignment = 64;
+
+	// Producers
+	alignas(alignment) std::atomic<node*> head_;
+	// Consumer
+	alignas(alignment) node* tail_;
+};
@@ -6,6 +6,8 @@
 #include <new>
 #include <cassert>
 
+#include "prefetch.hpp"
+
 #ifdef __cpp_lib_hardware_interference_size
     using std::hardware_constructive_interference_size;
     using std::hardware_destructive_interference_size;
@@ -29,8 +31,13 @@ public:
 	static_assert(std::is_move_assignable_v<T>, "T must be move constructible");
 	
 
-	explicit lock_free_spsc_queue(std::size_t capacity)
+	// prefetch_distance: 0 = off. Otherwise the producer prefetches (for write) the
+	// slot that many ahead of the one it fills, the consumer the one that many ahead
+	// of the one it reads. Pays off for large T, where every new slot is a miss;
+	// stel::default_prefetch_distance(sizeof(T)) is a sane pick.
+	explicit lock_free_spsc_queue(std::size_t capacity, std::size_t prefetch_distance = 0)
 		: cap_(capacity)
+		, prefetch_(prefetch_distance < capacity ? prefetch_distance : capacity - 1)
 		, buffer_(static_cast<T*>(::operator new[](cap_ * sizeof(T))))
 		, head_(0)
 		, tail_(0)
@@ -55,7 +62,8 @@ public:
 		if (next == head_.load(std::memory_order_acquire)) {
 			return false; // queue is full
 		}
-			
+
+		if (prefetch_) stel::prefetch_write(buffer_ + ((tail + prefetch_) & (cap_ - 1)), sizeof(T));
 		new (buffer_ + tail) T(std::move(value));
 		
 		tail_.store(next, std::memory_order_release);
@@ -72,6 +80,8 @@ public:
 			return std::nullopt; // queue is empty
 		}
 
+		if (prefetch_) stel::prefetch_read(buffer_ + ((head + prefetch_) & (cap_ - 1)), sizeof(T));
+
 		T value(std::move(reinterpret_cast<T&>(buffer_[head])));
 		(buffer_ + head)->~T();
 		
@@ -89,6 +99,8 @@ public:
 			return false; // queue is empty
 		}
 
+		if (prefetch_) stel::prefetch_read(buffer_ + ((head + prefetch_) & (cap_ - 1)), sizeof(T));
+
 		value = std::move(reinterpret_cast<T&>(buffer_[head]));
 		(buffer_ + head)->~T();
 		
@@ -96,11 +108,93 @@ public:
 		return true;
 	}
 
-	bool empty() const noexcept {  
+	// Batched produce: moves up to n items from first into the ring, in order,
+	// and publishes them with a single tail_ store. One acquire of head_ per
+	// batch instead of one per item. Items that didn't fit are left untouched.
+	// Returns how many were pushed.
+	std::size_t push_bulk(T* first, std::size_t n) {
+		const auto tail = tail_.load(std::memory_order_relaxed);
+		const auto head = head_.load(std::memory_order_acquire);
+
+		std::size_t room = (head - tail - 1 + cap_) & (cap_ - 1);
+		if (room > n) room = n;
+
+		std::size_t i = tail;
+		try {
+			for (std::size_t k = 0; k < room; ++k) {
+				if (prefetch_) stel::prefetch_write(buffer_ + ((i + prefetch_) & (cap_ - 1)), sizeof(T));
+				new (buffer_ + i) T(std::move(first[k]));
+				i = next_(i);
+			}
+		} catch (...) {
+			// Publish what was constructed so the consumer (or ~queue) owns it
+			tail_.store(i, std::memory_order_release);
+			throw;
+		}
+
+		if (room != 0) {
+			tail_.store(i, std::memory_order_release);
+		}
+		return room;
+	}
+
+	// Batched consume: hands up to max items to f (as T&), in order, then frees
+	// them all with a single head_ store. One acquire of tail_ per batch instead
+	// of one per item. Returns how many items were consumed. If f throws, the
+	// items before the one it threw on are consumed and the exception propagates;
+	// that one and the rest stay queued.
+	template <typename F>
+	std::size_t pop_bulk(F&& f, std::size_t max) {
+		const auto head = head_.load(std::memory_order_relaxed);
+		const auto tail = tail_.load(std::memory_order_acquire);
+
+		std::size_t avail = (tail - head + cap_) & (cap_ - 1);
+		if (avail > max) avail = max;
+
+		std::size_t i = head;
+		try {
+			for (std::size_t n = 0; n < avail; ++n) {
+				if (prefetch_) stel::prefetch_read(buffer_ + ((i + prefetch_) & (cap_ - 1)), sizeof(T));
+				T& item = reinterpret_cast<T&>(buffer_[i]);
+				f(item);
+				item.~T();
+				i = next_(i);
+			}
+		} catch (...) {
+			// Items before i are already destroyed - release them, or the next
+			// pop (or ~queue) would destroy them again
+			head_.store(i, std::memory_order_release);
+			throw;
+		}
+
+		if (avail != 0) {
+			head_.store(i, std::memory_order_release);
+		}
+		return avail;
+	}
+
+	// Consumer only: the oldest item without removing it, nullptr if empty.
+	// Valid until the next pop.
+	T* front() noexcept {
+		const auto head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		return buffer_ + head;
+	}
+
+	// Producer only: true if try_push would fail right now. Can only turn
+	// false behind our back, so a push after !full() always succeeds.
+	bool full() const noexcept {
+		return next_(tail_.load(std::memory_order_relaxed)) == head_.load(std::memory_order_acquire);
+	}
+
+	bool empty() const noexcept {
 		return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
 	}
 
 	std::size_t capacity() const noexcept { return cap_ - 1; }
+	std::size_t prefetch_distance() const noexcept { return prefetch_; }
 	// maybe_size - Getting a consistent head and tail for a size is not trivial
 	// as the size can be stale at the moment is returned.
 	std::size_t maybe_size() const { 
@@ -114,6 +208,7 @@ private:
 	//std::size_t next_(std::size_t i) const noexcept { return (i + 1) % cap_; }
 
 	std::size_t cap_;
+	std::size_t prefetch_; // in slots, 0 = off
 	
 	// Avoid default constructing T objects.
 	// This buffer holds raw, uninitialized memory.
@@ -0,0 +1,518 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stel {
+
+namespace journal_detail {
+
+inline constexpr std::uint64_t magic = 0x4c414e524a4c4554ULL; // "TELJRNAL"
+inline constexpr std::size_t header_bytes = 64;
+inline constexpr std::size_t entry_header = 8;
+
+inline constexpr std::uint32_t state_empty = 0;
+inline constexpr std::uint32_t state_entry = 1;
+inline constexpr std::uint32_t state_end = 2;
+
+struct segment_header {
+	std::uint64_t magic;        // written last
+	std::uint64_t number;
+	std::uint64_t first_index;
+	std::uint64_t size;
+};
+
+inline std::size_t align8(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+inline std::string segment_path(const std::string& dir, std::uint64_t n) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016" PRIu64 ".journal", n);
+	return dir + "/" + name;
+}
+
+// Highest segment number in dir, -1 if none
+inline std::int64_t last_segment(const std::string& dir) {
+	std::int64_t last = -1;
+	DIR* d = ::opendir(dir.c_str());
+	if (!d) return last;
+	while (dirent* e = ::readdir(d)) {
+		std::uint64_t n;
+		char tail[16];
+		if (std::sscanf(e->d_name, "%16" SCNu64 "%15s", &n, tail) == 2 && std::strcmp(tail, ".journal") == 0) {
+			if (static_cast<std::int64_t>(n) > last) last = static_cast<std::int64_t>(n);
+		}
+	}
+	::closedir(d);
+	return last;
+}
+
+inline std::uint32_t load_state(const std::byte* p) {
+	return std::atomic_ref<std::uint32_t>(*reinterpret_cast<std::uint32_t*>(const_cast<std::byte*>(p)))
+		.load(std::memory_order_acquire);
+}
+
+inline void store_state(std::byte* p, std::uint32_t s) {
+	std::atomic_ref<std::uint32_t>(*reinterpret_cast<std::uint32_t*>(p)).store(s, std::memory_order_release);
+}
+
+inline std::uint64_t load_magic(const std::byte* base) {
+	return std::atomic_ref<std::uint64_t>(*reinterpret_cast<std::uint64_t*>(const_cast<std::byte*>(base)))
+		.load(std::memory_order_acquire);
+}
+
+// One mapped segment file
+class segment {
+public:
+	segment() = default;
+	segment(const segment&) = delete;
+	segment& operator =(const segment&) = delete;
+	segment(segment&& o) noexcept { swap(o); }
+	segment& operator =(segment&& o) noexcept { segment t(std::move(o)); swap(t); return *this; }
+	~segment() { reset(); }
+
+	// Create (and pre-fault) a new segment for writing
+	static segment create(const std::string& dir, std::uint64_t number, std::size_t size) {
+		segment s;
+		s.number_ = number;
+		s.size_ = size;
+		const std::string path = segment_path(dir, number);
+		s.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (s.fd_ < 0) throw std::system_error(errno, std::generic_category(), "journal: create " + path);
+		if (::ftruncate(s.fd_, static_cast<off_t>(size)) != 0) {
+			throw std::system_error(errno, std::generic_category(), "journal: ftruncate");
+		}
+		// Reserve the blocks now, not on first touch. Not every file system can.
+		(void)::posix_fallocate(s.fd_, 0, static_cast<off_t>(size));
+		s.map_(PROT_READ | PROT_WRITE, MAP_POPULATE);
+		return s;
+	}
+
+	// Map an existing segment. Returns an empty segment if it doesn't exist (yet).
+	static segment open(const std::string& dir, std::uint64_t number, bool writable) {
+		segment s;
+		const std::string path = segment_path(dir, number);
+		s.fd_ = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+		if (s.fd_ < 0) {
+			if (errno == ENOENT) return segment{};
+			throw std::system_error(errno, std::generic_category(), "journal: open " + path);
+		}
+		struct stat st;
+		if (::fstat(s.fd_, &st) != 0 || static_cast<std::size_t>(st.st_size) < header_bytes) {
+			return segment{}; // still being created
+		}
+		s.number_ = number;
+		s.size_ = static_cast<std::size_t>(st.st_size);
+		s.map_(writable ? PROT_READ | PROT_WRITE : PROT_READ, 0);
+		return s;
+	}
+
+	explicit operator bool() const noexcept { return base_ != nullptr; }
+	std::byte* base() const noexcept { return base_; }
+	std::size_t size() const noexcept { return size_; }
+	std::uint64_t number() const noexcept { return number_; }
+
+	bool ready() const noexcept { return base_ && load_magic(base_) == magic; }
+	const segment_header& header() const noexcept { return *reinterpret_cast<const segment_header*>(base_); }
+
+	// Fill in the header, magic last: readers ignore the segment until then
+	void publish(std::uint64_t first_index) {
+		auto* h = reinterpret_cast<segment_header*>(base_);
+		h->number = number_;
+		h->first_index = first_index;
+		h->size = size_;
+		std::atomic_ref<std::uint64_t>(h->magic).store(magic, std::memory_order_release);
+	}
+
+	void sync() {
+		if (base_) ::msync(base_, size_, MS_ASYNC);
+	}
+
+	void reset() {
+		if (base_) ::munmap(base_, size_);
+		if (fd_ >= 0) ::close(fd_);
+		base_ = nullptr;
+		fd_ = -1;
+	}
+
+private:
+	void map_(int prot, int extra) {
+		void* p = ::mmap(nullptr, size_, prot, MAP_SHARED | extra, fd_, 0);
+		if (p == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "journal: mmap");
+		base_ = static_cast<std::byte*>(p);
+	}
+
+	void swap(segment& o) noexcept {
+		std::swap(fd_, o.fd_);
+		std::swap(base_, o.base_);
+		std::swap(size_, o.size_);
+		std::swap(number_, o.number_);
+	}
+
+	int fd_ = -1;
+	std::byte* base_ = nullptr;
+	std::size_t size_ = 0;
+	std::uint64_t number_ = 0;
+};
+
+// Creates segments on its own thread, so the appender never waits for the
+// open/ftruncate/fallocate/page faults of a 64MB file.
+class segment_preparer {
+public:
+	segment_preparer(const std::string& dir, std::size_t size)
+		: dir_(dir)
+		, size_(size)
+		, thread_([this] { run_(); })
+	{ }
+
+	~segment_preparer() {
+		{
+			std::lock_guard lock(m_);
+			stop_ = true;
+		}
+		cv_.notify_all();
+		thread_.join();
+	}
+
+	segment_preparer(const segment_preparer&) = delete;
+	segment_preparer& operator =(const segment_preparer&) = delete;
+
+	// Start creating segment `number`, returns immediately
+	void request(std::uint64_t number) {
+		{
+			std::lock_guard lock(m_);
+			if (state_ != idle) return;
+			number_ = number;
+			state_ = requested;
+		}
+		cv_.notify_all();
+	}
+
+	// Segment `number`, waiting for it if it is still being created. One that was
+	// never requested is created right here. Creation errors surface here too.
+	segment take(std::uint64_t number) {
+		std::unique_lock lock(m_);
+		if (state_ == idle || number_ != number) {
+			if (state_ == ready || state_ == failed) { // not the one we want, drop it
+				seg_.reset();
+				error_ = nullptr;
+				state_ = idle;
+			}
+			lock.unlock();
+			return segment::create(dir_, number, size_);
+		}
+		cv_.wait(lock, [this] { return state_ == ready || state_ == failed; });
+		const bool ok = state_ == ready;
+		state_ = idle;
+		if (!ok) std::rethrow_exception(std::exchange(error_, nullptr));
+		return std::move(seg_);
+	}
+
+private:
+	enum state { idle, requested, creating, ready, failed };
+
+	void run_() {
+		std::unique_lock lock(m_);
+		for (;;) {
+			cv_.wait(lock, [this] { return stop_ || state_ == requested; });
+			if (stop_) return;
+			state_ = creating;
+			const std::uint64_t n = number_;
+			lock.unlock();
+			segment s;
+			std::exception_ptr err;
+			try {
+				s = segment::create(dir_, n, size_);
+			} catch (...) {
+				err = std::current_exception();
+			}
+			lock.lock();
+			seg_ = std::move(s);
+			error_ = err;
+			state_ = err ? failed : ready;
+			cv_.notify_all();
+		}
+	}
+
+	const std::string dir_;
+	const std::size_t size_;
+	std::mutex m_;
+	std::condition_variable cv_;
+	state state_ = idle;
+	bool stop_ = false;
+	std::uint64_t number_ = 0;
+	segment seg_;
+	std::exception_ptr error_;
+	std::thread thread_; // last: starts once everything above is initialised
+};
+
+} // namespace journal_detail
+
+// Memory-mapped, append-only journal (Chronicle-queue style)
+//
+// The journal is a directory of fixed-size segment files 0000000000000000.journal,
+// 0000000000000001.journal, ... Each one is mapped MAP_SHARED, the appender writes
+// entries with a memcpy and publishes them with a release store of the entry header,
+// and tailers in this or any other process read the same page cache pages. The file
+// is the ring: there is no separate queue, and everything that went through is on
+// disk for replay.
+//
+// Segment layout:
+//	[ header: magic | segment no | first index | size ]   64 bytes
+//	[ entry ][ entry ] ...
+// Entry layout, 8 byte aligned:
+//	[ u32 state | u32 len ][ payload, padded to 8 ]
+//	state: 0 = not written yet, 1 = entry, 2 = end of segment (continue in the next file)
+//
+// Entries are numbered from 0 across segments. When the appender crosses half of
+// a segment it asks a helper thread to create, size (fallocate) and pre-fault the
+// next one, so rolling over is just a pointer swap - append() only waits if the
+// helper hasn't finished by then (a segment filled in less time than it takes to
+// create one).
+//
+// Single appender per journal. Page cache persistence only - call sync() for msync.
+class journal_appender {
+public:
+	// Opens the journal in dir (which must exist), continuing after the last entry
+	explicit journal_appender(std::string dir, std::size_t segment_bytes = 64 << 20)
+		: dir_(std::move(dir))
+		, segment_bytes_(segment_bytes < 4096 ? 4096 : journal_detail::align8(segment_bytes))
+		, preparer_(dir_, segment_bytes_)
+	{
+		using namespace journal_detail;
+		std::int64_t last = last_segment(dir_);
+		// A segment without magic was pre-allocated but never rolled into
+		// (or we crashed creating it) - the journal continues in the one before
+		while (last >= 0) {
+			cur_ = segment::open(dir_, static_cast<std::uint64_t>(last), true);
+			if (cur_.ready()) break;
+			cur_.reset();
+			::unlink(segment_path(dir_, static_cast<std::uint64_t>(last)).c_str());
+			--last;
+		}
+		if (last < 0) {
+			cur_ = segment::create(dir_, 0, segment_bytes_);
+			cur_.publish(0);
+			pos_ = header_bytes;
+			next_index_ = 0;
+			return;
+		}
+
+		// roll_() publishes the next segment before it writes the end marker, so a
+		// crash in between leaves the previous segment open-ended and tailers would
+		// wait there forever. Close it now.
+		if (last > 0) {
+			segment prev = segment::open(dir_, static_cast<std::uint64_t>(last - 1), true);
+			if (prev.ready()) {
+				std::uint64_t index = prev.header().first_index;
+				const std::size_t end = walk_entries_(prev, index);
+				if (load_state(prev.base() + end) != state_end) {
+					store_state(prev.base() + end, state_end);
+				}
+			}
+		}
+
+		// Recovery: walk the entries to the first unwritten slot
+		next_index_ = cur_.header().first_index;
+		pos_ = walk_entries_(cur_, next_index_);
+		if (load_state(cur_.base() + pos_) == state_end) {
+			roll_();
+		}
+	}
+
+	journal_appender(const journal_appender&) = delete;
+	journal_appender& operator =(const journal_appender&) = delete;
+
+	// Returns the index of the new entry
+	std::uint64_t append(const void* data, std::size_t len) {
+		using namespace journal_detail;
+		const std::size_t need = entry_header + align8(len);
+		if (need + entry_header > segment_bytes_ - header_bytes || len > UINT32_MAX) {
+			throw std::invalid_argument("journal: entry larger than a segment");
+		}
+		// Always keep room for the end-of-segment marker
+		if (pos_ + need + entry_header > cur_.size()) {
+			roll_();
+		}
+
+		std::byte* p = cur_.base() + pos_;
+		const std::uint32_t len32 = static_cast<std::uint32_t>(len);
+		std::memcpy(p + 4, &len32, sizeof(len32));
+		std::memcpy(p + entry_header, data, len);
+		store_state(p, state_entry); // publish
+
+		pos_ += need;
+		if (!next_requested_ && pos_ > cur_.size() / 2) {
+			preparer_.request(cur_.number() + 1);
+			next_requested_ = true;
+		}
+		return next_index_++;
+	}
+
+	std::uint64_t next_index() const noexcept { return next_index_; }
+
+	// Ask the kernel to start writing dirty pages back
+	void sync() { cur_.sync(); }
+
+private:
+	// Offset of the first slot in s that isn't an entry, counting entries into
+	// index. A length that would run past the end marker's room is garbage, the
+	// walk stops there.
+	static std::size_t walk_entries_(const journal_detail::segment& s, std::uint64_t& index) {
+		using namespace journal_detail;
+		std::size_t pos = header_bytes;
+		while (load_state(s.base() + pos) == state_entry) {
+			std::uint32_t len;
+			std::memcpy(&len, s.base() + pos + 4, sizeof(len));
+			const std::size_t next = pos + entry_header + align8(len);
+			if (next + entry_header > s.size()) break;
+			pos = next;
+			++index;
+		}
+		return pos;
+	}
+
+	void roll_() {
+		using namespace journal_detail;
+		segment next = preparer_.take(cur_.number() + 1);
+		next_requested_ = false;
+		// Header first, then the end marker - a tailer following the marker must
+		// find the next segment ready
+		next.publish(next_index_);
+		if (load_state(cur_.base() + pos_) != state_end) {
+			store_state(cur_.base() + pos_, state_end);
+		}
+		cur_ = std::move(next);
+		pos_ = header_bytes;
+	}
+
+	const std::string dir_;
+	const std::size_t segment_bytes_;
+	journal_detail::segment_preparer preparer_;
+	journal_detail::segment cur_;
+	bool next_requested_ = false;
+	std::size_t pos_ = 0;
+	std::uint64_t next_index_ = 0;
+};
+
+// Reads a journal by index, concurrently with the appender (same or another process)
+class journal_tailer {
+public:
+	explicit journal_tailer(std::string dir, std::uint64_t start_index = 0)
+		: dir_(std::move(dir))
+	{
+		seek(start_index);
+	}
+
+	journal_tailer(const journal_tailer&) = delete;
+	journal_tailer& operator =(const journal_tailer&) = delete;
+
+	// Position at entry `index`. If it hasn't been written yet, the tailer waits
+	// at the end of the journal and picks entries up as they arrive.
+	void seek(std::uint64_t index) {
+		using namespace journal_detail;
+		target_ = index;
+		seg_.reset();
+		const std::int64_t last = last_segment(dir_);
+		// Walk back to the segment whose first index is <= index
+		for (std::int64_t n = last; n >= 0; --n) {
+			segment s = segment::open(dir_, static_cast<std::uint64_t>(n), false);
+			if (s.ready() && s.header().first_index <= index) {
+				seg_ = std::move(s);
+				break;
+			}
+		}
+		next_index_ = 0;
+		pos_ = header_bytes;
+		if (!seg_) return;
+
+		next_index_ = seg_.header().first_index;
+		while (next_index_ < index) {
+			const std::uint32_t state = load_state(seg_.base() + pos_);
+			if (state == state_entry) {
+				skip_();
+			} else if (state == state_end) {
+				if (!advance_()) return;
+			} else {
+				return; // index is in the future
+			}
+		}
+	}
+
+	// Calls f(index, data, len) for the next entry if it's there. Non-blocking.
+	// data points into the mapping and is valid until the next call.
+	template <typename F>
+	bool try_read(F&& f) {
+		using namespace journal_detail;
+		for (;;) {
+			if (!seg_ && !open_first_()) return false;
+			const std::uint32_t state = load_state(seg_.base() + pos_);
+			if (state == state_entry && next_index_ < target_) {
+				skip_(); // seek() ran ahead of the appender
+				continue;
+			}
+			if (state == state_entry) {
+				std::uint32_t len;
+				std::memcpy(&len, seg_.base() + pos_ + 4, sizeof(len));
+				f(next_index_, static_cast<const std::byte*>(seg_.base() + pos_ + entry_header),
+						static_cast<std::size_t>(len));
+				skip_();
+				return true;
+			}
+			if (state != state_end || !advance_()) return false;
+		}
+	}
+
+	std::uint64_t next_index() const noexcept { return next_index_; }
+
+private:
+	void skip_() {
+		using namespace journal_detail;
+		std::uint32_t len;
+		std::memcpy(&len, seg_.base() + pos_ + 4, sizeof(len));
+		pos_ += entry_header + align8(len);
+		++next_index_;
+	}
+
+	bool advance_() {
+		using namespace journal_detail;
+		segment next = segment::open(dir_, seg_.number() + 1, false);
+		if (!next.ready()) return false; // appender is mid-rollover, try again later
+		seg_ = std::move(next);
+		pos_ = header_bytes;
+		return true;
+	}
+
+	// Journal didn't exist when we were constructed
+	bool open_first_() {
+		seek(target_);
+		return static_cast<bool>(seg_);
+	}
+
+	const std::string dir_;
+	journal_detail::segment seg_;
+	std::size_t pos_ = 0;
+	std::uint64_t next_index_ = 0;
+	std::uint64_t target_ = 0;
+};
+
+} // namespace stel
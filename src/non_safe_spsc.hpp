@@ -28,6 +28,12 @@ public:
 		return buffer[head_];
 	}
 
+	// Same, without the copy: the oldest element in place, nullptr when empty.
+	// It may be moved from before try_pop().
+	T* peek() {
+		return empty() ? nullptr : &buffer[head_];
+	}
+
 	bool empty() const { return size_ == 0; }
 	std::size_t capacity() const { return Size; }
 	std::size_t size() const { return size_; }
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "treiber_stack.hpp"
+
+namespace stel {
+
+// Fixed-size object pool
+//
+// All objects live in one contiguous block allocated up front. Each object gets a
+// cache line aligned slot (sizeof(T) rounded up to a multiple of 64), so two objects
+// handed to different threads never share a line.
+//
+// Free slots are tracked as indices in an index_stack, the shared lock-free freelist.
+// It's LIFO, so the slot released last (still warm in cache) is the next one handed
+// out. Going to the shared stack on every acquire/release makes all threads hammer
+// its top, so threads are expected to go through a cache: a small per-thread magazine
+// of free indices that is refilled from / flushed to the stack half a magazine at a
+// time. Most operations then touch thread-local memory only.
+//
+//	stel::object_pool<msg> pool(1 << 16);
+//	stel::object_pool<msg>::cache c(pool);     // one per thread
+//	msg* m = c.acquire(args...);
+//	...
+//	c.release(m);                             // any thread's cache can release it
+template <typename T>
+class object_pool {
+public:
+	static constexpr std::size_t cache_line = 64;
+	static constexpr std::size_t slot_align = alignof(T) > cache_line ? alignof(T) : cache_line;
+	static constexpr std::size_t stride = (sizeof(T) + slot_align - 1) / slot_align * slot_align;
+
+	explicit object_pool(std::size_t count)
+		: count_(count)
+		, storage_(static_cast<unsigned char*>(
+			::operator new(count_ * stride, std::align_val_t(slot_align))))
+		, free_(count_, true)
+	{
+		assert(count_ > 0 && count_ < UINT32_MAX);
+	}
+
+	object_pool(const object_pool&) = delete;
+	object_pool& operator =(const object_pool&) = delete;
+	object_pool(object_pool&&) = delete;
+	object_pool& operator =(object_pool&&) = delete;
+
+	// Every object must have been released, and every cache destroyed, by now.
+	~object_pool() {
+		::operator delete(storage_, std::align_val_t(slot_align));
+	}
+
+	// Straight from the shared stack, no cache. nullptr when the pool is exhausted.
+	template <typename... Args>
+	T* acquire(Args&&... args) {
+		std::uint32_t idx;
+		if (!free_.try_pop(idx)) return nullptr;
+		try {
+			return construct_(idx, std::forward<Args>(args)...);
+		} catch (...) {
+			free_.push(idx); // T's constructor threw, the slot is still free
+			throw;
+		}
+	}
+
+	void release(T* obj) {
+		free_.push(destroy_(obj));
+	}
+
+	std::size_t capacity() const noexcept { return count_; }
+
+	// Racy count of slots on the shared stack (not including the ones parked in caches)
+	std::size_t maybe_free() const { return free_.maybe_size(); }
+
+	// Per-thread magazine. Not thread safe - one per thread, it must not outlive the pool.
+	class cache {
+	public:
+		explicit cache(object_pool& pool, std::size_t magazine = 64)
+			: pool_(pool), cap_(magazine < 2 ? 2 : magazine)
+		{
+			mag_.reserve(cap_);
+		}
+
+		cache(const cache&) = delete;
+		cache& operator =(const cache&) = delete;
+
+		// Parked indices go back to the shared stack
+		~cache() {
+			for (std::uint32_t idx : mag_) {
+				pool_.free_.push(idx);
+			}
+		}
+
+		template <typename... Args>
+		T* acquire(Args&&... args) {
+			if (mag_.empty() && !refill_()) return nullptr;
+			// Take the index only once construction succeeded, so a throwing
+			// constructor leaves the slot in the magazine
+			T* obj = pool_.construct_(mag_.back(), std::forward<Args>(args)...);
+			mag_.pop_back();
+			return obj;
+		}
+
+		void release(T* obj) {
+			if (mag_.size() == cap_) {
+				flush_();
+			}
+			mag_.push_back(pool_.destroy_(obj));
+		}
+
+		std::size_t size() const noexcept { return mag_.size(); }
+
+	private:
+		// Take half a magazine so a thread bouncing around the boundary doesn't
+		// go to the stack on every call
+		bool refill_() {
+			std::uint32_t idx;
+			for (std::size_t i = 0; i < cap_ / 2 && pool_.free_.try_pop(idx); ++i) {
+				mag_.push_back(idx);
+			}
+			return !mag_.empty();
+		}
+
+		void flush_() {
+			for (std::size_t i = 0; i < cap_ / 2; ++i) {
+				pool_.free_.push(mag_.back());
+				mag_.pop_back();
+			}
+		}
+
+		object_pool& pool_;
+		const std::size_t cap_;
+		std::vector<std::uint32_t> mag_;
+	};
+
+private:
+	template <typename... Args>
+	T* construct_(std::uint32_t idx, Args&&... args) {
+		void* p = storage_ + static_cast<std::size_t>(idx) * stride;
+		return new (p) T(std::forward<Args>(args)...);
+	}
+
+	std::uint32_t destroy_(T* obj) {
+		const auto offset = static_cast<std::size_t>(reinterpret_cast<unsigned char*>(obj) - storage_);
+		assert(offset % stride == 0 && offset / stride < count_ && "object not from this pool");
+		obj->~T();
+		return static_cast<std::uint32_t>(offset / stride);
+	}
+
+	const std::size_t count_;
+	unsigned char* const storage_;
+	index_stack free_;
+};
+
+} // namespace stel
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "backoff.hpp"
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Staged pipeline: thread -> SPSC ring -> thread -> ...
+//
+// Declare a source and any number of stages, the pipeline creates one thread per
+// stage worker, one lock_free_spsc_queue per (upstream worker, downstream worker)
+// pair, and optionally pins every worker to its own core.
+//
+// A stage with parallelism > 1 gets several workers. Each upstream worker fans out
+// round-robin (a whole batch at a time) over its rings to them, and every worker
+// polls all its input rings, so fan-out and fan-in need no shared queue. Order is
+// only preserved between stages with a single worker.
+//
+// Items move in batches: a worker pops up to `batch` items from one ring with a
+// single pop_bulk, runs the stage on all of them, and pushes the batch into one
+// output ring with a single push_bulk before moving on (spilling into the next
+// ring if it doesn't fit), so ring indices are exchanged once per batch.
+//
+// Every stage takes and produces the same T - use a struct or variant if stages
+// need to change representation, and T must be default constructible (workers keep
+// a batch buffer of them). The last stage is the sink, its items are dropped.
+//
+//	stel::pipeline<packet> p;
+//	p.source("read", [&](packet& out) { return reader.next(out); })
+//	 .stage("parse", parse)
+//	 .stage("enrich", enrich, 2)
+//	 .stage("write", write);
+//	p.run();
+template <typename T>
+class pipeline {
+public:
+	struct options {
+		std::size_t ring_capacity = 1024; // per ring, power of 2
+		std::size_t batch = 32;
+		bool pin = true;
+		unsigned first_cpu = 0;           // workers take consecutive cpus from here
+	};
+
+	struct stage_stats {
+		std::string name;
+		std::size_t workers;
+		std::uint64_t items;     // processed so far
+		double items_per_sec;    // since start, until the stage finished
+		double occupancy;        // fill ratio of the stage's input rings right now, 0..1
+	};
+
+	pipeline() : pipeline(options{}) { }
+	explicit pipeline(options o) : opt_(o) {
+		// A zero batch would never pop or pull anything, and never finish
+		if (opt_.batch == 0) opt_.batch = 1;
+	}
+
+	pipeline(const pipeline&) = delete;
+	pipeline& operator =(const pipeline&) = delete;
+
+	~pipeline() {
+		wait();
+	}
+
+	// Produces items until it returns false. Always a single worker.
+	pipeline& source(std::string name, std::function<bool(T&)> f) {
+		assert(stages_.empty() && "source must come first");
+		stages_.push_back(std::make_unique<stage_node>(std::move(name), nullptr, std::move(f), 1));
+		return *this;
+	}
+
+	pipeline& stage(std::string name, std::function<void(T&)> f, std::size_t parallelism = 1) {
+		assert(!stages_.empty() && "declare the source first");
+		stages_.push_back(std::make_unique<stage_node>(std::move(name), std::move(f), nullptr,
+					parallelism == 0 ? 1 : parallelism));
+		return *this;
+	}
+
+	// Wire the rings and start all workers
+	void start() {
+		assert(!started_ && stages_.size() >= 2);
+		started_ = true;
+
+		for (auto& s : stages_) {
+			for (std::size_t w = 0; w < s->parallelism; ++w) {
+				s->workers.push_back(std::make_unique<worker>());
+			}
+		}
+		for (std::size_t i = 0; i + 1 < stages_.size(); ++i) {
+			for (auto& up : stages_[i]->workers) {
+				for (auto& down : stages_[i + 1]->workers) {
+					links_.push_back(std::make_unique<link>(opt_.ring_capacity));
+					up->outputs.push_back(links_.back().get());
+					down->inputs.push_back(links_.back().get());
+				}
+			}
+		}
+
+		start_time_ = clock::now();
+		unsigned cpu = opt_.first_cpu;
+		for (auto& s : stages_) {
+			stage_node* sp = s.get();
+			sp->running.store(sp->parallelism, std::memory_order_relaxed);
+			for (auto& w : s->workers) {
+				worker* wp = w.get();
+				threads_.emplace_back([this, sp, wp, cpu] {
+					if (opt_.pin) pin_current_thread(cpu);
+					if (sp->source) run_source_(*sp, *wp);
+					else run_stage_(*sp, *wp);
+					finish_(*sp, *wp);
+				});
+				++cpu;
+			}
+		}
+	}
+
+	// Block until the source is exhausted and every item went through the sink
+	void wait() {
+		for (auto& t : threads_) {
+			if (t.joinable()) t.join();
+		}
+	}
+
+	void run() {
+		start();
+		wait();
+	}
+
+	// Safe to call while running (values are sampled, not a consistent snapshot)
+	std::vector<stage_stats> stats() const {
+		std::vector<stage_stats> out;
+		const auto now = clock::now();
+		for (auto& s : stages_) {
+			stage_stats st{s->name, s->parallelism, 0, 0.0, 0.0};
+			std::size_t used = 0;
+			std::size_t cap = 0;
+			const bool finished = started_ && s->running.load(std::memory_order_acquire) == 0;
+			auto end = finished ? start_time_ : now;
+			for (auto& w : s->workers) {
+				st.items += w->items.load(std::memory_order_relaxed);
+				for (link* l : w->inputs) {
+					used += l->q.maybe_size();
+					cap += l->q.capacity();
+				}
+				if (finished && w->end_time > end) end = w->end_time;
+			}
+			const double secs = std::chrono::duration<double>(end - start_time_).count();
+			st.items_per_sec = secs > 0 ? static_cast<double>(st.items) / secs : 0.0;
+			st.occupancy = cap ? static_cast<double>(used) / static_cast<double>(cap) : 0.0;
+			out.push_back(std::move(st));
+		}
+		return out;
+	}
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	struct link {
+		explicit link(std::size_t cap) : q(cap), closed(false) { }
+		lock_free_spsc_queue<T> q;
+		// Set by the producer after its last push
+		alignas(64) std::atomic<bool> closed;
+	};
+
+	struct worker {
+		std::vector<link*> inputs;
+		std::vector<link*> outputs;
+		std::size_t out_cursor = 0;
+		clock::time_point end_time{};
+		alignas(64) std::atomic<std::uint64_t> items{0};
+	};
+
+	struct stage_node {
+		stage_node(std::string n, std::function<void(T&)> f, std::function<bool(T&)> src, std::size_t par)
+			: name(std::move(n)), fn(std::move(f)), source(std::move(src)), parallelism(par) { }
+
+		std::string name;
+		std::function<void(T&)> fn;
+		std::function<bool(T&)> source;
+		std::size_t parallelism;
+		std::vector<std::unique_ptr<worker>> workers;
+		std::atomic<std::size_t> running{0};
+	};
+
+	void run_source_(stage_node& s, worker& w) {
+		std::vector<T> buf(opt_.batch);
+		std::uint64_t items = 0;
+		for (bool more = true; more; ) {
+			std::size_t n = 0;
+			while (n < opt_.batch && (more = s.source(buf[n]))) ++n;
+			emit_(w, buf, n);
+			items += n;
+			w.items.store(items, std::memory_order_relaxed);
+		}
+	}
+
+	void run_stage_(stage_node& s, worker& w) {
+		std::vector<T> buf(opt_.batch);
+		std::uint64_t items = 0;
+		std::size_t in = 0;
+		backoff idle;
+		for (;;) {
+			bool progress = false;
+			for (std::size_t k = 0; k < w.inputs.size(); ++k, in = (in + 1) % w.inputs.size()) {
+				auto& q = w.inputs[in]->q;
+				std::size_t n = 0;
+				q.pop_bulk([&](T& item) { buf[n++] = std::move(item); }, opt_.batch);
+				if (n == 0) continue;
+
+				for (std::size_t i = 0; i < n; ++i) s.fn(buf[i]);
+				emit_(w, buf, n);
+				items += n;
+				w.items.store(items, std::memory_order_relaxed);
+				progress = true;
+			}
+			if (progress) {
+				idle.reset();
+			} else {
+				if (inputs_done_(w)) break;
+				idle.pause();
+			}
+		}
+	}
+
+	// closed is read before emptiness: once a closed ring is seen empty it stays empty
+	static bool inputs_done_(const worker& w) {
+		for (link* l : w.inputs) {
+			if (!l->closed.load(std::memory_order_acquire) || !l->q.empty()) return false;
+		}
+		return true;
+	}
+
+	// Push a batch downstream, round-robin one batch per ring, each with a single
+	// push_bulk. Whatever doesn't fit goes to the next ring, so one slow worker
+	// doesn't stall its siblings; we only back off once every ring is full.
+	void emit_(worker& w, std::vector<T>& buf, std::size_t n) {
+		if (w.outputs.empty()) return; // sink
+		const std::size_t outs = w.outputs.size();
+		std::size_t tried = 0;
+		backoff full;
+		for (std::size_t i = 0; i < n; ) {
+			const std::size_t pushed = w.outputs[w.out_cursor]->q.push_bulk(buf.data() + i, n - i);
+			w.out_cursor = (w.out_cursor + 1) % outs;
+			i += pushed;
+			if (pushed != 0) {
+				tried = 0;
+			} else if (++tried == outs) {
+				tried = 0;
+				full.pause();
+			}
+		}
+	}
+
+	void finish_(stage_node& s, worker& w) {
+		for (link* l : w.outputs) {
+			l->closed.store(true, std::memory_order_release);
+		}
+		w.end_time = clock::now();
+		// Published by the release, stats() reads end_time only after seeing 0
+		s.running.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	options opt_;
+	bool started_ = false;
+	std::vector<std::unique_ptr<stage_node>> stages_;
+	std::vector<std::unique_ptr<link>> links_;
+	std::vector<std::thread> threads_;
+	clock::time_point start_time_{};
+};
+
+} // namespace stel
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+namespace stel {
+
+// Software prefetch of an object spanning `bytes`, one hint per cache line.
+//
+// prefetch_write asks for the line in exclusive state, so the later store doesn't
+// have to upgrade a shared line. On x86 that needs prefetchw, which GCC/Clang only
+// emit when it is enabled (-mprfchw or an -march that has it); the default x86-64
+// target gets a plain prefetcht0. ARM gets pstl1keep. Both are hints: no fault on
+// bad addresses, no effect on correctness.
+//
+// Big objects are capped at max_lines, past that the hardware prefetcher has long
+// picked up the sequential stream anyway.
+inline constexpr std::size_t prefetch_line = 64;
+inline constexpr std::size_t prefetch_max_lines = 16;
+
+inline void prefetch_read(const void* p, std::size_t bytes) noexcept {
+	const char* c = static_cast<const char*>(p);
+	const std::size_t lines = (bytes + prefetch_line - 1) / prefetch_line;
+	for (std::size_t i = 0; i < lines && i < prefetch_max_lines; ++i) {
+		__builtin_prefetch(c + i * prefetch_line, 0, 3);
+	}
+}
+
+inline void prefetch_write(const void* p, std::size_t bytes) noexcept {
+	const char* c = static_cast<const char*>(p);
+	const std::size_t lines = (bytes + prefetch_line - 1) / prefetch_line;
+	for (std::size_t i = 0; i < lines && i < prefetch_max_lines; ++i) {
+		__builtin_prefetch(c + i * prefetch_line, 1, 3);
+	}
+}
+
+// A reasonable slot distance for items of `bytes`: about 4 cache lines ahead for
+// small items (so the prefetch lands on a line not yet touched), 2 items ahead for
+// items of a line or more. Items smaller than a line share lines, prefetching one
+// slot ahead would mostly hit the line we're on.
+constexpr std::size_t default_prefetch_distance(std::size_t bytes) noexcept {
+	if (bytes >= prefetch_line) return 2;
+	return (4 * prefetch_line + bytes - 1) / bytes;
+}
+
+} // namespace stel
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "backoff.hpp"
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Consumer side of a capture path: drains a lock_free_spsc_queue<T> to a file.
+//
+// Two threads:
+//	* the drain thread empties the ring with pop_bulk() into the current buffer,
+//	  and hands full buffers (or partial ones after flush_interval) to the writer
+//	* the writer thread writes every buffer handed to it with one writev() call
+//
+// With at least two buffers the drain thread keeps filling one while the writer is
+// stuck in the kernel, so a disk stall only reaches the producer once every buffer is
+// waiting to be written (counted in stalls()).
+//
+// With direct = true the file is opened O_DIRECT: buffers are page aligned, writes
+// are multiples of 4096 and the unaligned tail is carried into the next buffer. The
+// last write is padded and the file truncated back to the real size. If the file
+// system refuses O_DIRECT the sink silently uses buffered writes (see direct()).
+//
+// T must be trivially copyable - items are written as raw bytes.
+template <typename T>
+class ring_sink {
+public:
+	static_assert(std::is_trivially_copyable_v<T>, "ring_sink writes raw bytes");
+
+	struct options {
+		std::size_t buffer_bytes = 1 << 20;
+		std::size_t buffers = 2;
+		bool direct = false;
+		std::chrono::microseconds flush_interval{1000};
+	};
+
+	ring_sink(lock_free_spsc_queue<T>& ring, const char* path)
+		: ring_sink(ring, path, options{}) { }
+
+	ring_sink(lock_free_spsc_queue<T>& ring, const char* path, options opt)
+		: ring_(ring)
+		, opt_(fix_(opt))
+		, ready_(queue_cap_(opt_.buffers))
+		, free_(queue_cap_(opt_.buffers))
+	{
+		int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+		if (opt_.direct) {
+			fd_ = ::open(path, flags | O_DIRECT, 0644);
+			direct_ = fd_ >= 0;
+		}
+		if (fd_ < 0) {
+			fd_ = ::open(path, flags, 0644);
+		}
+		if (fd_ < 0) {
+			throw std::system_error(errno, std::generic_category(), "ring_sink: open");
+		}
+
+		memory_ = static_cast<std::byte*>(
+				::operator new(opt_.buffers * opt_.buffer_bytes, std::align_val_t(page)));
+		for (std::uint32_t i = 0; i < opt_.buffers; ++i) {
+			free_.try_push(i);
+		}
+
+		writer_ = std::thread([this] { run_writer_(); });
+		drain_ = std::thread([this] { run_drain_(); });
+	}
+
+	ring_sink(const ring_sink&) = delete;
+	ring_sink& operator =(const ring_sink&) = delete;
+
+	~ring_sink() {
+		stop();
+		::operator delete(memory_, std::align_val_t(page));
+		::close(fd_);
+	}
+
+	// Drain whatever is left in the ring, write it and join. The producer must be done.
+	void stop() {
+		stop_.store(true, std::memory_order_release);
+		if (drain_.joinable()) drain_.join();
+		if (writer_.joinable()) writer_.join();
+	}
+
+	bool direct() const noexcept { return direct_; }
+	std::uint64_t bytes_written() const noexcept { return bytes_.load(std::memory_order_relaxed); }
+	std::uint64_t writes() const noexcept { return writes_.load(std::memory_order_relaxed); }
+	// Times the drain thread had no free buffer, i.e. the disk was behind
+	std::uint64_t stalls() const noexcept { return stalls_.load(std::memory_order_relaxed); }
+	// errno of the first failed write, 0 if none
+	int error() const noexcept { return error_.load(std::memory_order_acquire); }
+
+private:
+	static constexpr std::size_t page = 4096;
+
+	struct handoff {
+		std::uint32_t buffer;
+		std::size_t len;    // bytes of payload
+		bool last;
+	};
+
+	static options fix_(options o) {
+		if (o.buffers < 2) o.buffers = 2;
+		// Room for at least one item plus a carried O_DIRECT tail, in whole pages
+		std::size_t min = sizeof(T) + page;
+		if (o.buffer_bytes < min) o.buffer_bytes = min;
+		o.buffer_bytes = (o.buffer_bytes + page - 1) / page * page;
+		return o;
+	}
+
+	static std::size_t queue_cap_(std::size_t n) {
+		std::size_t p = 2;
+		while (p < n + 1) p <<= 1;
+		return p;
+	}
+
+	std::byte* buffer_(std::uint32_t i) const noexcept { return memory_ + std::size_t(i) * opt_.buffer_bytes; }
+
+	std::uint32_t take_free_() {
+		std::uint32_t idx;
+		if (free_.try_pop(idx)) return idx;
+		stalls_.fetch_add(1, std::memory_order_relaxed);
+		backoff b;
+		while (!free_.try_pop(idx)) {
+			b.pause();
+		}
+		return idx;
+	}
+
+	void run_drain_() {
+		using clock = std::chrono::steady_clock;
+		std::uint32_t cur = take_free_();
+		std::size_t used = 0;
+		auto last_handoff = clock::now();
+		backoff idle;
+
+		// Hand the buffer over. O_DIRECT can only take whole pages, the rest
+		// moves to the front of the next buffer.
+		auto hand_over = [&] {
+			const std::size_t len = direct_ ? used / page * page : used;
+			if (len == 0) return;
+			const std::uint32_t next = take_free_();
+			const std::size_t carry = used - len;
+			std::memcpy(buffer_(next), buffer_(cur) + len, carry);
+			ready_.try_push(handoff{cur, len, false});
+			cur = next;
+			used = carry;
+			last_handoff = clock::now();
+		};
+
+		for (;;) {
+			const bool stopping = stop_.load(std::memory_order_acquire);
+			std::byte* const base = buffer_(cur);
+			const std::size_t n = ring_.pop_bulk([&](T& v) {
+				std::memcpy(base + used, &v, sizeof(T));
+				used += sizeof(T);
+			}, (opt_.buffer_bytes - used) / sizeof(T));
+
+			if (opt_.buffer_bytes - used < sizeof(T)) {
+				hand_over();
+				continue;
+			}
+			if (n != 0) {
+				idle.reset();
+				continue;
+			}
+
+			if (stopping) {
+				// stop_ was set before this pass and the ring was empty - nothing more comes
+				ready_.try_push(handoff{cur, used, true});
+				return;
+			}
+			if (used != 0 && clock::now() - last_handoff >= opt_.flush_interval) {
+				hand_over();
+			}
+			idle.pause();
+		}
+	}
+
+	void run_writer_() {
+		std::vector<handoff> batch;
+		std::vector<iovec> iov;
+		std::uint64_t logical = 0; // bytes of real data in the file
+		bool padded = false;
+		backoff idle;
+
+		for (bool done = false; !done; ) {
+			batch.clear();
+			handoff h;
+			while (batch.size() < IOV_MAX && ready_.try_pop(h)) {
+				batch.push_back(h);
+				if (h.last) break;
+			}
+			if (batch.empty()) {
+				idle.pause();
+				continue;
+			}
+			idle.reset();
+
+			iov.clear();
+			for (const handoff& b : batch) {
+				std::size_t len = b.len;
+				if (b.last && direct_ && len % page != 0) {
+					// Final partial page: pad with zeros, truncate afterwards
+					const std::size_t aligned = (len + page - 1) / page * page;
+					std::memset(buffer_(b.buffer) + len, 0, aligned - len);
+					len = aligned;
+					padded = true;
+				}
+				if (len != 0) iov.push_back(iovec{buffer_(b.buffer), len});
+				logical += b.len;
+				done |= b.last;
+			}
+			write_all_(iov);
+
+			for (const handoff& b : batch) {
+				if (!b.last) free_.try_push(b.buffer);
+			}
+		}
+
+		if (padded && ::ftruncate(fd_, static_cast<off_t>(logical)) != 0) {
+			set_error_(errno);
+		}
+	}
+
+	void write_all_(std::vector<iovec>& v) {
+		iovec* iov = v.data();
+		std::size_t n = v.size();
+		while (n > 0) {
+			const ssize_t w = ::writev(fd_, iov, static_cast<int>(n));
+			if (w < 0) {
+				if (errno == EINTR) continue;
+				set_error_(errno);
+				return;
+			}
+			writes_.fetch_add(1, std::memory_order_relaxed);
+			bytes_.fetch_add(static_cast<std::uint64_t>(w), std::memory_order_relaxed);
+
+			std::size_t left = static_cast<std::size_t>(w);
+			while (n > 0 && left >= iov->iov_len) {
+				left -= iov->iov_len;
+				++iov;
+				--n;
+			}
+			if (n > 0) {
+				iov->iov_base = static_cast<std::byte*>(iov->iov_base) + left;
+				iov->iov_len -= left;
+			}
+		}
+	}
+
+	void set_error_(int e) {
+		int expected = 0;
+		error_.compare_exchange_strong(expected, e, std::memory_order_acq_rel);
+	}
+
+	lock_free_spsc_queue<T>& ring_;
+	const options opt_;
+	int fd_ = -1;
+	bool direct_ = false;
+	std::byte* memory_ = nullptr;
+
+	// drain -> writer: filled buffers, writer -> drain: empty buffers
+	lock_free_spsc_queue<handoff> ready_;
+	lock_free_spsc_queue<std::uint32_t> free_;
+
+	std::atomic<bool> stop_{false};
+	std::atomic<std::uint64_t> bytes_{0};
+	std::atomic<std::uint64_t> writes_{0};
+	std::atomic<std::uint64_t> stalls_{0};
+	std::atomic<int> error_{0};
+
+	std::thread writer_;
+	std::thread drain_;
+};
+
+} // namespace stel
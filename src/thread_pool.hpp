@@ -1,6 +1,7 @@
 #pragma once 
 
 #include <vector>
+#include <atomic>
 #include <thread>
 #include <functional>
 
@@ -13,7 +14,9 @@ class thread_pool {
 public:
 	using Task = std::function<void()>;
 
-	thread_pool(std::size_t workers) {
+	thread_pool(std::size_t workers) 
+		: accepting_(true), pending_(0)
+	{
 		workers_.reserve(workers);
 		for (std::size_t i = 0; i < workers; ++i) {
 			workers_.emplace_back(std::thread([&]() {
@@ -29,19 +32,52 @@ public:
 
 	~thread_pool() {
 		task_.shutdown();
-		for (auto& th : workers_) {
-			if (th.joinable()) {
-				th.join();
-			}
-		}
+		join_();
 	}
 
+	// Returns false if the pool is draining or shut down.
 	template <typename F>
-	void submit(F&& f) {
-		task_.push(std::forward<F>(f));
+	bool submit(F&& f) {
+		// Same ordering as bounded_mpmc_pool::submit: count first, then check
+		// accepting_, so drain() can't miss a task that slipped in.
+		pending_.fetch_add(1, std::memory_order_seq_cst);
+		if (!accepting_.load(std::memory_order_seq_cst)) {
+			finish_one_();
+			return false;
+		}
+		// shutdown() may have run since the check and the workers may be gone;
+		// the queue refuses then, instead of keeping a task nobody will run
+		if (!task_.try_push(std::forward<F>(f))) {
+			finish_one_();
+			return false;
+		}
+		return true;
+	}
+
+	// Block until the queue is empty and no worker is running a task.
+	// Don't call it from inside a task.
+	void wait_idle() const {
+		std::size_t n = pending_.load(std::memory_order_acquire);
+		while (n != 0) {
+			pending_.wait(n, std::memory_order_acquire);
+			n = pending_.load(std::memory_order_acquire);
+		}
+	}
+
+	// Reject new tasks, finish everything queued, then stop and join the workers.
+	void drain() {
+		accepting_.store(false, std::memory_order_seq_cst);
+		wait_idle();
+		task_.shutdown();
+		join_();
+	}
+
+	std::size_t pending() const noexcept {
+		return pending_.load(std::memory_order_relaxed);
 	}
 
 	void shutdown() {
+		accepting_.store(false, std::memory_order_seq_cst);
 		task_.shutdown();
 	}
 
@@ -53,9 +89,28 @@ private:
 				break;
 			}
 			t();
+			finish_one_();
 		}
 	}
+
+	void finish_one_() {
+		if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			pending_.notify_all();
+		}
+	}
+
+	void join_() {
+		for (auto& th : workers_) {
+			if (th.joinable()) {
+				th.join();
+			}
+		}
+	}
+
 	std::vector<std::thread> workers_;
 	thread_safe_queue<Task> task_;
+	std::atomic<bool> accepting_;
+	// Tasks pushed and not finished yet (queued + running)
+	std::atomic<std::size_t> pending_;
 };
 } // namespace stel
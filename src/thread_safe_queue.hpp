@@ -37,7 +37,31 @@ public:
 		}
 
 		size_.fetch_add(1, std::memory_order_relaxed);
-		cv_.notify_one();
+		notify_one_();
+	}
+
+	// push() that refuses once shutdown() has been called. stop_ is checked under
+	// tail_mutex_: a consumer that saw stop_ read the tail after it was set, so
+	// either it sees this node or we see stop_ - nothing is left behind unseen.
+	bool try_push(T value) {
+
+		const std::shared_ptr data(std::make_shared<T>(std::move(value)));
+		std::unique_ptr<node> dummy = std::make_unique<node>();
+		node* new_tail = dummy.get();
+
+		{
+			std::lock_guard lock(tail_mutex_);
+			if (stop_.load(std::memory_order_relaxed)) {
+				return false;
+			}
+			tail_->data = std::move(data);
+			tail_->next = std::move(dummy);
+			tail_ = new_tail;
+		}
+
+		size_.fetch_add(1, std::memory_order_relaxed);
+		notify_one_();
+		return true;
 	}
 
 	std::shared_ptr<T> pop() {
@@ -123,6 +147,16 @@ private:
 	// in case this queue is used within a context like a thread pool
 	std::atomic<bool> stop_;
 
+	// wait_and_pop() checks the tail under head_mutex_, so a notify sent between
+	// that check and cv_.wait() would be lost. Taking head_mutex_ after the node
+	// is published orders the notify after any such waiter has started waiting.
+	void notify_one_() {
+		{
+			std::lock_guard lock(head_mutex_);
+		}
+		cv_.notify_one();
+	}
+
 	node* get_tail_() {
 		std::lock_guard lock(tail_mutex_);
 		return tail_;
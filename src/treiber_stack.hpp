@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+// Lock-free LIFO of indices in [0, capacity) - a Treiber stack for freelists.
+//
+// LIFO is the point: the index released last is handed out next, while its slot is
+// still warm in the releasing core's cache. mpmc_bounded_queue gives the coldest one.
+//
+// Nodes are the indices themselves (next_[i] is the link of index i), so no memory
+// is allocated or reclaimed after construction. ABA is handled by packing the top
+// index with a 32-bit tag into one 64-bit word, bumped on every successful CAS:
+// a pop that read top = A, next = B can't succeed after A was popped and pushed
+// back in between, because the tag moved on.
+//
+// Under contention failed CASes go to an elimination array: a push parks its index
+// in a random slot for a short while, a pop that also lost the race grabs it, and
+// both return without touching top_ at all. Slots carry their own sequence number
+// so a pusher withdrawing its offer can't be confused with a new offer of the same
+// index.
+//
+// An index must not be pushed while it is already on the stack.
+class index_stack {
+public:
+	static constexpr std::uint32_t none = UINT32_MAX;
+
+	struct options {
+		std::size_t elimination_slots = 8; // 0 turns elimination off
+		unsigned elimination_spins = 64;   // how long a push waits for a taker
+	};
+
+	// full = true starts with every index on the stack, 0 on top
+	explicit index_stack(std::size_t capacity, bool full = false)
+		: index_stack(capacity, full, options{}) { }
+
+	index_stack(std::size_t capacity, bool full, options opt)
+		: cap_(capacity)
+		, next_(std::make_unique<std::atomic<std::uint32_t>[]>(capacity))
+		, slots_(opt.elimination_slots)
+		, elim_(std::make_unique<elim_slot[]>(opt.elimination_slots))
+		, spins_(opt.elimination_spins)
+		, top_(pack_(none, 0))
+	{
+		assert(capacity < none);
+		if (full) {
+			for (std::size_t i = 0; i < cap_; ++i) {
+				next_[i].store(i + 1 < cap_ ? static_cast<std::uint32_t>(i + 1) : none, std::memory_order_relaxed);
+			}
+			top_.store(pack_(cap_ ? 0 : none, 0), std::memory_order_relaxed);
+		}
+	}
+
+	index_stack(const index_stack&) = delete;
+	index_stack& operator =(const index_stack&) = delete;
+
+	void push(std::uint32_t idx) noexcept {
+		assert(idx < cap_);
+		std::uint64_t top = top_.load(std::memory_order_relaxed);
+		for (;;) {
+			next_[idx].store(index_(top), std::memory_order_relaxed);
+			if (top_.compare_exchange_weak(top, pack_(idx, tag_(top) + 1),
+					std::memory_order_release, std::memory_order_relaxed)) {
+				return;
+			}
+			if (slots_ && offer_(idx)) return;
+			top = top_.load(std::memory_order_relaxed);
+		}
+	}
+
+	bool try_pop(std::uint32_t& idx) noexcept {
+		std::uint64_t top = top_.load(std::memory_order_acquire);
+		for (;;) {
+			const std::uint32_t i = index_(top);
+			if (i == none) {
+				// The stack is empty but a pusher may be parked in the array
+				return slots_ && take_(idx);
+			}
+			// May read a stale link if i was popped meanwhile - the CAS then fails on the tag
+			const std::uint32_t next = next_[i].load(std::memory_order_relaxed);
+			if (top_.compare_exchange_weak(top, pack_(next, tag_(top) + 1),
+					std::memory_order_acquire, std::memory_order_acquire)) {
+				idx = i;
+				return true;
+			}
+			if (slots_ && take_(idx)) return true;
+			top = top_.load(std::memory_order_acquire);
+		}
+	}
+
+	bool empty_hint() const noexcept { return index_(top_.load(std::memory_order_relaxed)) == none; }
+
+	// Walks the links, O(size). Only exact when nobody is pushing or popping;
+	// otherwise just a hint, but always safe since links are plain indices.
+	std::size_t maybe_size() const noexcept {
+		std::size_t n = 0;
+		for (std::uint32_t i = index_(top_.load(std::memory_order_acquire)); i != none && n < cap_; ++n) {
+			i = next_[i].load(std::memory_order_relaxed);
+		}
+		return n;
+	}
+
+	std::size_t capacity() const noexcept { return cap_; }
+
+	// Pushes/pops that met in the elimination array instead of going through top_
+	std::uint64_t eliminated() const noexcept { return eliminated_.load(std::memory_order_relaxed); }
+
+private:
+	// Slot word: [seq:32][index:32], index == none means no offer
+	struct alignas(hardware_destructive_interference_size) elim_slot {
+		std::atomic<std::uint64_t> word{pack_(none, 0)};
+	};
+
+	static constexpr std::uint64_t pack_(std::uint32_t idx, std::uint32_t tag) noexcept {
+		return (static_cast<std::uint64_t>(tag) << 32) | idx;
+	}
+	static constexpr std::uint32_t index_(std::uint64_t w) noexcept { return static_cast<std::uint32_t>(w); }
+	static constexpr std::uint32_t tag_(std::uint64_t w) noexcept { return static_cast<std::uint32_t>(w >> 32); }
+
+	// Cheap per-thread xorshift to pick slots, no shared state
+	static std::uint32_t random_() noexcept {
+		thread_local std::uint32_t x = static_cast<std::uint32_t>(
+			reinterpret_cast<std::uintptr_t>(&x) >> 4) | 1;
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+		return x;
+	}
+
+	elim_slot& pick_() noexcept { return elim_[random_() % slots_]; }
+
+	// Park idx in a slot and wait for a pop to take it. true if one did.
+	bool offer_(std::uint32_t idx) noexcept {
+		elim_slot& s = pick_();
+		std::uint64_t w = s.word.load(std::memory_order_relaxed);
+		if (index_(w) != none) return false;
+		const std::uint64_t offered = pack_(idx, tag_(w) + 1);
+		if (!s.word.compare_exchange_strong(w, offered, std::memory_order_release, std::memory_order_relaxed)) {
+			return false;
+		}
+		for (unsigned i = 0; i < spins_; ++i) {
+			if (s.word.load(std::memory_order_relaxed) != offered) {
+				eliminated_.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		// Nobody came: withdraw. Failing means a pop took it just now.
+		std::uint64_t expected = offered;
+		if (s.word.compare_exchange_strong(expected, pack_(none, tag_(offered) + 1),
+				std::memory_order_relaxed, std::memory_order_relaxed)) {
+			return false;
+		}
+		eliminated_.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool take_(std::uint32_t& idx) noexcept {
+		elim_slot& s = pick_();
+		std::uint64_t w = s.word.load(std::memory_order_acquire);
+		if (index_(w) == none) return false;
+		if (!s.word.compare_exchange_strong(w, pack_(none, tag_(w) + 1),
+				std::memory_order_acquire, std::memory_order_relaxed)) {
+			return false;
+		}
+		idx = index_(w);
+		return true;
+	}
+
+	const std::size_t cap_;
+	std::unique_ptr<std::atomic<std::uint32_t>[]> next_;
+	const std::size_t slots_;
+	std::unique_ptr<elim_slot[]> elim_;
+	const unsigned spins_;
+
+	alignas(hardware_destructive_interference_size) std::atomic<std::uint64_t> top_;
+	alignas(hardware_destructive_interference_size) std::atomic<std::uint64_t> eliminated_{0};
+};
+
+} // namespace stel
@@ -0,0 +1,474 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define STEL_HAVE_IO_URING 1
+#else
+#define STEL_HAVE_IO_URING 0
+#endif
+
+#include "backoff.hpp"
+#include "lock_free_spsc.hpp"
+
+namespace stel {
+
+namespace detail {
+
+#if STEL_HAVE_IO_URING
+// Bare io_uring over raw syscalls - just what file_ingest needs: read SQEs,
+// submit, reap. No liburing dependency.
+class uring {
+public:
+	explicit uring(unsigned entries) {
+		io_uring_params p;
+		std::memset(&p, 0, sizeof(p));
+		fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+		if (fd_ < 0) return;
+
+		sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+		cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+		single_mmap_ = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (single_mmap_) {
+			sq_size_ = cq_size_ = (sq_size_ > cq_size_ ? sq_size_ : cq_size_);
+		}
+
+		sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				fd_, IORING_OFF_SQ_RING);
+		if (sq_ptr_ == MAP_FAILED) { close_(); return; }
+		cq_ptr_ = single_mmap_ ? sq_ptr_
+			: ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+					fd_, IORING_OFF_CQ_RING);
+		if (cq_ptr_ == MAP_FAILED) { close_(); return; }
+
+		sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+		sqes_ = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+		if (sqes_ == MAP_FAILED) { sqes_ = nullptr; close_(); return; }
+
+		auto* sq = static_cast<char*>(sq_ptr_);
+		sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+		sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+		sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+		auto* cq = static_cast<char*>(cq_ptr_);
+		cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+		cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+		cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+		cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+	}
+
+	~uring() { close_(); }
+
+	uring(const uring&) = delete;
+	uring& operator =(const uring&) = delete;
+
+	bool ok() const noexcept { return fd_ >= 0; }
+
+	// Whether the kernel implements `op`. io_uring_setup() works from 5.1 but
+	// IORING_OP_READ only exists from 5.6, which is also when the probe arrived -
+	// a kernel that can't answer the probe can't do the read either.
+	bool supports(unsigned op) const {
+		constexpr unsigned max_ops = 256;
+		std::vector<unsigned char> buf(sizeof(io_uring_probe) + max_ops * sizeof(io_uring_probe_op));
+		auto* probe = reinterpret_cast<io_uring_probe*>(buf.data());
+		if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, max_ops) < 0) {
+			return false;
+		}
+		return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+	}
+
+	// Queue a read, it's handed to the kernel by the next enter()
+	void prep_read(int fd, void* buf, unsigned len, std::uint64_t offset, std::uint64_t user_data) {
+		const unsigned tail = *sq_tail_; // only we write it
+		const unsigned idx = tail & sq_mask_;
+		io_uring_sqe& sqe = sqes_[idx];
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = fd;
+		sqe.addr = reinterpret_cast<std::uintptr_t>(buf);
+		sqe.len = len;
+		sqe.off = offset;
+		sqe.user_data = user_data;
+		sq_array_[idx] = idx;
+		std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+		++to_submit_;
+	}
+
+	// Submit what's queued, optionally block until `wait_for` completions are ready
+	int enter(unsigned wait_for) {
+		const unsigned flags = wait_for ? IORING_ENTER_GETEVENTS : 0;
+		for (;;) {
+			const long r = ::syscall(__NR_io_uring_enter, fd_, to_submit_, wait_for, flags, nullptr, 0);
+			if (r >= 0) {
+				to_submit_ -= static_cast<unsigned>(r);
+				return 0;
+			}
+			if (errno != EINTR) return -errno;
+		}
+	}
+
+	// Calls f(user_data, res) for every completion available, returns how many
+	template <typename F>
+	unsigned reap(F&& f) {
+		unsigned head = *cq_head_;
+		const unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+		unsigned n = 0;
+		for (; head != tail; ++head, ++n) {
+			const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+			f(cqe.user_data, cqe.res);
+		}
+		std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+		return n;
+	}
+
+private:
+	void close_() {
+		if (sqes_) ::munmap(sqes_, sqes_size_);
+		if (cq_ptr_ && cq_ptr_ != MAP_FAILED && !single_mmap_) ::munmap(cq_ptr_, cq_size_);
+		if (sq_ptr_ && sq_ptr_ != MAP_FAILED) ::munmap(sq_ptr_, sq_size_);
+		if (fd_ >= 0) ::close(fd_);
+		sqes_ = nullptr;
+		cq_ptr_ = sq_ptr_ = nullptr;
+		fd_ = -1;
+	}
+
+	int fd_ = -1;
+	bool single_mmap_ = false;
+	void* sq_ptr_ = nullptr;
+	void* cq_ptr_ = nullptr;
+	std::size_t sq_size_ = 0;
+	std::size_t cq_size_ = 0;
+	std::size_t sqes_size_ = 0;
+	io_uring_sqe* sqes_ = nullptr;
+
+	unsigned* sq_tail_ = nullptr;
+	unsigned sq_mask_ = 0;
+	unsigned* sq_array_ = nullptr;
+	unsigned* cq_head_ = nullptr;
+	unsigned* cq_tail_ = nullptr;
+	unsigned cq_mask_ = 0;
+	io_uring_cqe* cqes_ = nullptr;
+	unsigned to_submit_ = 0;
+};
+#endif
+
+} // namespace detail
+
+// A filled chunk of the file, read in place from ingest-owned memory.
+// Hand it back with file_ingest::release() once done.
+struct ingest_chunk {
+	const std::byte* data;
+	std::size_t size;
+	std::uint64_t offset;   // file offset of data[0]
+	std::uint32_t buffer;   // which buffer to release
+};
+
+// Reads a file into a fixed set of buffers on a background thread and hands the
+// filled buffers to a single consumer through a lock_free_spsc_queue, in file order.
+//
+// The reads land directly in the buffers the consumer reads from - there is no
+// intermediate copy. With io_uring (raw syscalls) up to `chunks` reads are in flight
+// at once, completions are reordered back into file order before publishing. When
+// io_uring is unavailable (old kernel, no IORING_OP_READ before 5.6, seccomp,
+// disabled) it falls back to a plain pread loop on the same thread.
+//
+// With record_size set the chunk size is rounded down to a multiple of it, so
+// fixed-size records never straddle two chunks.
+//
+//	stel::file_ingest in("capture.bin", {.record_size = 64});
+//	stel::ingest_chunk c;
+//	while (in.next(c)) {
+//		parse(c.data, c.size);
+//		in.release(c);
+//	}
+class file_ingest {
+public:
+	struct options {
+		std::size_t chunk_size = 1 << 20;
+		std::size_t chunks = 8;
+		std::size_t record_size = 0;
+		bool use_uring = true;
+	};
+
+	explicit file_ingest(const char* path) : file_ingest(path, options{}) { }
+
+	file_ingest(const char* path, options opt)
+		: opt_(fix_(opt))
+		, filled_(queue_cap_(opt_.chunks))
+		, free_(queue_cap_(opt_.chunks))
+		, done_(false)
+		, error_(0)
+		, uring_(false)
+	{
+		fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (fd_ < 0) {
+			throw std::system_error(errno, std::generic_category(), "file_ingest: open");
+		}
+		struct stat st;
+		if (::fstat(fd_, &st) != 0) {
+			const int e = errno;
+			::close(fd_);
+			throw std::system_error(e, std::generic_category(), "file_ingest: fstat");
+		}
+		file_size_ = static_cast<std::uint64_t>(st.st_size);
+		::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+		// The destructor won't run if we throw from here on: undo by hand, like above
+		try {
+			// Page aligned, so the same buffers would also work for O_DIRECT reads
+			memory_ = static_cast<std::byte*>(
+					::operator new(opt_.chunks * opt_.chunk_size, std::align_val_t(4096)));
+			for (std::uint32_t i = 0; i < opt_.chunks; ++i) {
+				free_.try_push(i);
+			}
+
+			reader_ = std::thread([this] { run_(); });
+		} catch (...) {
+			if (memory_) ::operator delete(memory_, std::align_val_t(4096));
+			::close(fd_);
+			throw;
+		}
+	}
+
+	file_ingest(const file_ingest&) = delete;
+	file_ingest& operator =(const file_ingest&) = delete;
+
+	~file_ingest() {
+		stop_.store(true, std::memory_order_release);
+		if (reader_.joinable()) reader_.join();
+		::operator delete(memory_, std::align_val_t(4096));
+		::close(fd_);
+	}
+
+	// Non-blocking. False when nothing is ready right now - check finished().
+	bool try_next(ingest_chunk& out) {
+		return filled_.try_pop(out);
+	}
+
+	// Blocking (spins with backoff). False at end of file or on a read error.
+	bool next(ingest_chunk& out) {
+		for (backoff b; ; b.pause()) {
+			if (filled_.try_pop(out)) return true;
+			if (done_.load(std::memory_order_acquire)) {
+				// The reader pushes everything before setting done_
+				return filled_.try_pop(out);
+			}
+		}
+	}
+
+	void release(const ingest_chunk& c) {
+		free_.try_push(c.buffer); // sized for every buffer, can't fail
+	}
+
+	// Everything has been read (or failed) and handed out
+	bool finished() const noexcept {
+		return done_.load(std::memory_order_acquire) && filled_.empty();
+	}
+
+	// errno of the first failed read, 0 if none
+	int error() const noexcept { return error_.load(std::memory_order_acquire); }
+	bool using_uring() const noexcept { return uring_.load(std::memory_order_acquire); }
+	std::uint64_t file_size() const noexcept { return file_size_; }
+	std::size_t chunk_size() const noexcept { return opt_.chunk_size; }
+
+private:
+	static options fix_(options o) {
+		if (o.chunks == 0) o.chunks = 1;
+		if (o.record_size != 0) {
+			o.chunk_size = o.chunk_size / o.record_size * o.record_size;
+			if (o.chunk_size == 0) o.chunk_size = o.record_size;
+		}
+		if (o.chunk_size == 0) o.chunk_size = 1 << 20;
+		return o;
+	}
+
+	// lock_free_spsc_queue holds capacity - 1, and needs a power of 2
+	static std::size_t queue_cap_(std::size_t n) {
+		std::size_t p = 2;
+		while (p < n + 1) p <<= 1;
+		return p;
+	}
+
+	std::byte* buffer_(std::uint32_t i) const noexcept { return memory_ + std::size_t(i) * opt_.chunk_size; }
+
+	bool take_free_(std::uint32_t& idx) {
+		backoff b;
+		while (!free_.try_pop(idx)) {
+			if (stop_.load(std::memory_order_acquire)) return false;
+			b.pause();
+		}
+		return true;
+	}
+
+	void run_() {
+#if STEL_HAVE_IO_URING
+		if (opt_.use_uring) {
+			detail::uring ring(static_cast<unsigned>(opt_.chunks));
+			if (ring.ok() && ring.supports(IORING_OP_READ)) {
+				uring_.store(true, std::memory_order_release);
+				run_uring_(ring);
+				done_.store(true, std::memory_order_release);
+				return;
+			}
+		}
+#endif
+		run_pread_();
+		done_.store(true, std::memory_order_release);
+	}
+
+	void run_pread_() {
+		for (std::uint64_t off = 0; off < file_size_; ) {
+			std::uint32_t idx;
+			if (!take_free_(idx)) return;
+			const std::size_t want = static_cast<std::size_t>(
+					std::min<std::uint64_t>(opt_.chunk_size, file_size_ - off));
+			std::size_t got = 0;
+			while (got < want) {
+				const ssize_t r = ::pread(fd_, buffer_(idx) + got, want - got, static_cast<off_t>(off + got));
+				if (r < 0 && errno == EINTR) continue;
+				if (r <= 0) {
+					error_.store(r < 0 ? errno : EIO, std::memory_order_release);
+					return;
+				}
+				got += static_cast<std::size_t>(r);
+			}
+			filled_.try_push(ingest_chunk{buffer_(idx), got, off, idx});
+			off += got;
+		}
+	}
+
+#if STEL_HAVE_IO_URING
+	void run_uring_(detail::uring& ring) {
+		// In-flight state per buffer. user_data is the buffer index.
+		struct slot {
+			std::uint64_t seq;
+			std::uint64_t offset;
+			std::size_t want;
+			std::size_t got;
+			bool ready;
+		};
+		std::vector<slot> slots(opt_.chunks);
+		// Completed buffers waiting for their turn, indexed by seq % chunks
+		std::vector<std::int64_t> by_seq(opt_.chunks, -1);
+
+		std::uint64_t next_off = 0;
+		std::uint64_t next_seq = 0;     // next read to issue
+		std::uint64_t deliver_seq = 0;  // next chunk to publish
+		std::size_t inflight = 0;
+		backoff starved;
+
+		// The kernel may still be writing into our buffers, never leave with reads in flight
+		auto quiesce = [&] {
+			while (inflight > 0 && ring.enter(1) == 0) {
+				inflight -= ring.reap([](std::uint64_t, int) { });
+			}
+		};
+
+		auto submit = [&](std::uint32_t idx) {
+			slot& s = slots[idx];
+			ring.prep_read(fd_, buffer_(idx) + s.got, static_cast<unsigned>(s.want - s.got),
+					s.offset + s.got, idx);
+		};
+
+		while (deliver_seq < next_seq || next_off < file_size_) {
+			if (stop_.load(std::memory_order_acquire)) {
+				quiesce();
+				return;
+			}
+
+			// Issue reads into every free buffer
+			std::uint32_t idx;
+			while (next_off < file_size_ && free_.try_pop(idx)) {
+				const std::size_t want = static_cast<std::size_t>(
+						std::min<std::uint64_t>(opt_.chunk_size, file_size_ - next_off));
+				slots[idx] = slot{next_seq++, next_off, want, 0, false};
+				next_off += want;
+				submit(idx);
+				++inflight;
+			}
+
+			// Nothing in flight: we're waiting for the consumer to release buffers
+			if (inflight == 0) {
+				starved.pause();
+				continue;
+			}
+			starved.reset();
+			if (int e = ring.enter(1); e < 0) {
+				error_.store(-e, std::memory_order_release);
+				quiesce();
+				return;
+			}
+
+			bool failed = false;
+			ring.reap([&](std::uint64_t data, int res) {
+				slot& s = slots[static_cast<std::size_t>(data)];
+				if (res == -EINTR || res == -EAGAIN) {
+					submit(static_cast<std::uint32_t>(data));
+					return;
+				}
+				if (res <= 0) {
+					error_.store(res < 0 ? -res : EIO, std::memory_order_release);
+					failed = true;
+					--inflight;
+					return;
+				}
+				s.got += static_cast<std::size_t>(res);
+				if (s.got < s.want) {
+					submit(static_cast<std::uint32_t>(data)); // short read, ask for the rest
+					return;
+				}
+				--inflight;
+				by_seq[s.seq % opt_.chunks] = static_cast<std::int64_t>(data);
+			});
+			if (failed) {
+				quiesce();
+				return;
+			}
+
+			// Publish in file order
+			for (;;) {
+				std::int64_t& b = by_seq[deliver_seq % opt_.chunks];
+				if (b < 0) break;
+				const auto i = static_cast<std::uint32_t>(b);
+				filled_.try_push(ingest_chunk{buffer_(i), slots[i].got, slots[i].offset, i});
+				b = -1;
+				++deliver_seq;
+			}
+		}
+	}
+#endif
+
+	const options opt_;
+	int fd_ = -1;
+	std::uint64_t file_size_ = 0;
+	std::byte* memory_ = nullptr;
+
+	// reader -> consumer: filled buffers, consumer -> reader: buffers to refill
+	lock_free_spsc_queue<ingest_chunk> filled_;
+	lock_free_spsc_queue<std::uint32_t> free_;
+
+	std::atomic<bool> stop_{false};
+	std::atomic<bool> done_;
+	std::atomic<int> error_;
+	std::atomic<bool> uring_;
+	std::thread reader_;
+};
+
+} // namespace stel
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "actor.hpp"
+
+TEST(Actor, ProcessesEveryMessage) {
+	stel::thread_pool pool(4);
+	long long sum = 0; // only touched by the actor
+	{
+		stel::actor<int> a(pool, [&](int& v) { sum += v; }, 8);
+		for (int i = 1; i <= 1000; ++i) {
+			a.send(i);
+		}
+		pool.wait_idle();
+		EXPECT_TRUE(a.idle());
+	}
+	EXPECT_EQ(sum, 1000LL * 1001 / 2);
+}
+
+TEST(Actor, NeverRunsConcurrentlyAndKeepsPerSenderOrder) {
+	constexpr int senders = 4;
+	constexpr int per_sender = 5000;
+
+	stel::thread_pool pool(4);
+	std::atomic<int> inside{0};
+	std::atomic<int> overlaps{0};
+	std::vector<int> last(senders, -1);
+	int out_of_order = 0;
+
+	{
+		stel::actor<std::pair<int, int>> a(pool, [&](std::pair<int, int>& m) {
+			if (inside.fetch_add(1) != 0) overlaps.fetch_add(1);
+			if (m.second <= last[m.first]) ++out_of_order;
+			last[m.first] = m.second;
+			inside.fetch_sub(1);
+		}, 16);
+
+		std::vector<std::thread> ts;
+		for (int s = 0; s < senders; ++s) {
+			ts.emplace_back([&, s] {
+				for (int i = 0; i < per_sender; ++i) a.send({s, i});
+			});
+		}
+		for (auto& t : ts) t.join();
+		pool.wait_idle();
+	}
+
+	EXPECT_EQ(overlaps.load(), 0);
+	EXPECT_EQ(out_of_order, 0);
+	for (int s = 0; s < senders; ++s) {
+		EXPECT_EQ(last[s], per_sender - 1);
+	}
+}
+
+// Mailbox that stalls some senders right before and right after their push, i.e.
+// in the windows between send() counting a message and it becoming visible to the
+// run, and the other way round.
+template <typename T>
+struct stalling_mailbox {
+	void push(T value) {
+		const bool stall = (calls_.fetch_add(1, std::memory_order_relaxed) & 7) == 0;
+		if (stall) std::this_thread::sleep_for(std::chrono::microseconds(20));
+		q_.push(std::move(value));
+		if (stall) std::this_thread::sleep_for(std::chrono::microseconds(20));
+	}
+	std::optional<T> try_pop() { return q_.try_pop(); }
+
+	std::atomic<unsigned> calls_{0};
+	lock_free_mpsc_queue<T> q_;
+};
+
+TEST(Actor, SlowSendersNeverOverlapHandler) {
+	constexpr int senders = 4;
+	constexpr int per_sender = 2000;
+
+	stel::thread_pool pool(4);
+	std::atomic<int> inside{0};
+	std::atomic<int> overlaps{0};
+	int handled = 0; // only touched by the actor
+
+	{
+		stel::actor<int, stel::thread_pool, stalling_mailbox<int>> a(pool, [&](int&) {
+			if (inside.fetch_add(1) != 0) overlaps.fetch_add(1);
+			++handled;
+			inside.fetch_sub(1);
+		}, 4);
+
+		for (int round = 0; round < 5; ++round) {
+			std::vector<std::thread> ts;
+			for (int s = 0; s < senders; ++s) {
+				ts.emplace_back([&] {
+					for (int i = 0; i < per_sender; ++i) a.send(i);
+				});
+			}
+			for (auto& t : ts) t.join();
+			pool.wait_idle();
+			EXPECT_TRUE(a.idle());
+		}
+	}
+
+	EXPECT_EQ(overlaps.load(), 0);
+	EXPECT_EQ(handled, 5 * senders * per_sender);
+}
+
+TEST(Actor, SendAfterPoolDrainedIsRejected) {
+	stel::thread_pool pool(2);
+	int handled = 0;
+	stel::actor<int> a(pool, [&](int&) { ++handled; });
+	EXPECT_TRUE(a.send(1));
+	pool.drain();
+	EXPECT_EQ(handled, 1);
+
+	EXPECT_FALSE(a.send(2));
+	EXPECT_TRUE(a.idle());
+	EXPECT_EQ(handled, 1);
+}
+
+TEST(MPSCQueue, PushPop) {
+	lock_free_mpsc_queue<int> q;
+	EXPECT_TRUE(q.empty());
+	q.push(1);
+	q.push(2);
+	EXPECT_EQ(q.try_pop(), 1);
+	EXPECT_EQ(q.try_pop(), 2);
+	EXPECT_EQ(q.try_pop(), std::nullopt);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "async_logger.hpp"
+
+namespace {
+
+std::string read_all(std::FILE* f) {
+	std::string out;
+	std::fflush(f);
+	std::rewind(f);
+	char buf[4096];
+	std::size_t n;
+	while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+		out.append(buf, n);
+	}
+	return out;
+}
+
+}
+
+TEST(AsyncLogger, FormatsArguments) {
+	std::FILE* f = std::tmpfile();
+	ASSERT_NE(f, nullptr);
+	{
+		stel::async_logger log(fileno(f));
+		EXPECT_TRUE(log.log("int={} uint={} char={} str={}", -42, 7u, 'x', "hello"));
+		EXPECT_TRUE(log.log("double={} no args {}", 1.5));
+		EXPECT_TRUE(log.log("plain"));
+		log.flush();
+		EXPECT_EQ(log.written(), 3u);
+	}
+	EXPECT_EQ(read_all(f), "int=-42 uint=7 char=x str=hello\ndouble=1.5 no args {}\nplain\n");
+	std::fclose(f);
+}
+
+TEST(AsyncLogger, ManyThreads) {
+	constexpr int threads = 4;
+	constexpr int lines = 1000;
+
+	std::FILE* f = std::tmpfile();
+	ASSERT_NE(f, nullptr);
+	stel::async_logger log(fileno(f), 2048);
+
+	std::vector<std::thread> ts;
+	for (int t = 0; t < threads; ++t) {
+		ts.emplace_back([&, t] {
+			for (int i = 0; i < lines; ++i) {
+				// Ring may fill up, retry so the line count is exact
+				while (!log.log("thread {} line {}", t, i)) std::this_thread::yield();
+			}
+		});
+	}
+	for (auto& t : ts) t.join();
+	log.flush();
+
+	const std::string out = read_all(f);
+	EXPECT_EQ(static_cast<int>(std::count(out.begin(), out.end(), '\n')), threads * lines);
+	EXPECT_NE(out.find("thread 3 line 999\n"), std::string::npos);
+	std::fclose(f);
+}
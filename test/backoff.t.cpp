@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+#include "backoff.hpp"
+
+TEST(Backoff, CalibratedTuningIsSane) {
+	const auto& t = stel::backoff_tuning::calibrated();
+	EXPECT_GE(t.max_pauses, 4u);
+	EXPECT_LE(t.max_pauses, 1024u);
+	EXPECT_EQ(t.max_pauses & (t.max_pauses - 1), 0u);
+	EXPECT_GT(t.spin_steps, 4u);
+	// Same object every time, calibration runs once
+	EXPECT_EQ(&t, &stel::backoff_tuning::calibrated());
+}
+
+TEST(Backoff, ExhaustsAndResets) {
+	stel::backoff_tuning t;
+	t.max_pauses = 4;
+	t.spin_steps = 3;
+	t.yield_steps = 2;
+	stel::backoff b(t);
+	for (int i = 0; i < 5; ++i) {
+		EXPECT_FALSE(b.exhausted());
+		b.pause();
+	}
+	EXPECT_TRUE(b.exhausted());
+	b.pause(); // keeps yielding, stays exhausted
+	EXPECT_TRUE(b.exhausted());
+	b.reset();
+	EXPECT_FALSE(b.exhausted());
+}
+
+TEST(Backoff, WaitParksUntilNotified) {
+	stel::backoff_tuning t;
+	t.spin_steps = 1;
+	t.yield_steps = 1;
+	std::atomic<int> flag{0};
+
+	std::thread waiter([&] {
+		stel::backoff b(t);
+		for (int v; (v = flag.load(std::memory_order_acquire)) == 0; ) {
+			b.wait(flag, v);
+		}
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	flag.store(1, std::memory_order_release);
+	flag.notify_all();
+	waiter.join();
+	SUCCEED();
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "bqueue_spsc.hpp"
+
+TEST(BQueueSPSC, FullCapacityIsUsable) {
+	bqueue_spsc_queue<int> q(8, 4);
+	EXPECT_TRUE(q.empty());
+	for (int i = 0; i < 8; ++i) {
+		EXPECT_TRUE(q.try_push(i));
+	}
+	EXPECT_FALSE(q.try_push(8));
+
+	int v;
+	for (int i = 0; i < 8; ++i) {
+		ASSERT_TRUE(q.try_pop(v));
+		EXPECT_EQ(v, i);
+	}
+	EXPECT_FALSE(q.try_pop(v));
+	EXPECT_TRUE(q.empty());
+}
+
+TEST(BQueueSPSC, PartialBatchesBacktrack) {
+	bqueue_spsc_queue<int> q(64, 16);
+	// Fewer items than a batch: the consumer must still see them
+	for (int round = 0; round < 50; ++round) {
+		for (int i = 0; i < 3; ++i) EXPECT_TRUE(q.try_push(round * 3 + i));
+		for (int i = 0; i < 3; ++i) {
+			auto v = q.try_pop();
+			ASSERT_TRUE(v.has_value());
+			EXPECT_EQ(*v, round * 3 + i);
+		}
+		EXPECT_FALSE(q.try_pop().has_value());
+	}
+}
+
+TEST(BQueueSPSC, MoveOnlyAndLeftoversDestroyed) {
+	{
+		bqueue_spsc_queue<std::unique_ptr<int>> q(16);
+		for (int i = 0; i < 3; ++i) EXPECT_TRUE(q.try_push(std::make_unique<int>(i)));
+		std::unique_ptr<int> out;
+		ASSERT_TRUE(q.try_pop(out));
+		ASSERT_NE(out, nullptr);
+		EXPECT_EQ(*out, 0);
+		ASSERT_TRUE(q.try_pop(out));
+		EXPECT_EQ(*out, 1);
+	}
+
+	// shared_ptr only for use_count: leftovers must be destroyed with the queue
+	auto counter = std::make_shared<int>(0);
+	{
+		bqueue_spsc_queue<std::shared_ptr<int>> q(16);
+		for (int i = 0; i < 10; ++i) q.try_push(counter);
+		EXPECT_EQ(counter.use_count(), 11);
+		std::shared_ptr<int> out;
+		q.try_pop(out);
+	}
+	EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(BQueueSPSC, ProducerConsumer) {
+	constexpr std::uint64_t count = 1 << 20;
+	bqueue_spsc_queue<std::uint64_t> q(1024, 64);
+
+	std::thread producer([&] {
+		for (std::uint64_t i = 0; i < count; ++i) {
+			while (!q.try_push(i)) std::this_thread::yield();
+		}
+	});
+
+	bool ordered = true;
+	std::uint64_t v;
+	for (std::uint64_t i = 0; i < count; ++i) {
+		while (!q.try_pop(v)) std::this_thread::yield();
+		ordered &= v == i;
+	}
+	producer.join();
+	EXPECT_TRUE(ordered);
+	EXPECT_TRUE(q.empty());
+}
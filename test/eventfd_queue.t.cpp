@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "eventfd_queue.hpp"
+
+namespace {
+
+// Consumer parked in epoll_wait, producers push `total` items in bursts
+template <typename Q>
+void epoll_consume(Q& q, int producers, int per_producer) {
+	const int ep = ::epoll_create1(0);
+	epoll_event ev{};
+	ev.events = EPOLLIN;
+	ev.data.fd = q.fd();
+	ASSERT_EQ(::epoll_ctl(ep, EPOLL_CTL_ADD, q.fd(), &ev), 0);
+
+	std::vector<std::thread> ts;
+	for (int p = 0; p < producers; ++p) {
+		ts.emplace_back([&] {
+			for (int i = 0; i < per_producer; ++i) {
+				while (!q.try_push(1)) std::this_thread::yield();
+				if (i % 100 == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		});
+	}
+
+	long long got = 0;
+	const long long total = 1LL * producers * per_producer;
+	while (got < total) {
+		epoll_event out;
+		const int n = ::epoll_wait(ep, &out, 1, 2000);
+		ASSERT_EQ(n, 1) << "lost wakeup, got " << got << " of " << total;
+		q.consume_event();
+		do {
+			got += static_cast<long long>(q.drain([](int) { }));
+		} while (!q.arm());
+	}
+	for (auto& t : ts) t.join();
+	::close(ep);
+
+	EXPECT_EQ(got, total);
+	// Far fewer signals than messages
+	EXPECT_LT(q.signals(), static_cast<std::uint64_t>(total));
+}
+
+}
+
+TEST(EventfdQueue, SPSCWakesEpoll) {
+	stel::eventfd_spsc_queue<int> q(1024);
+	epoll_consume(q, 1, 20000);
+}
+
+TEST(EventfdQueue, MPMCWakesEpoll) {
+	stel::eventfd_mpmc_queue<int> q(1024);
+	epoll_consume(q, 4, 5000);
+}
+
+TEST(EventfdQueue, NoSignalWhileDisarmed) {
+	stel::eventfd_spsc_queue<int> q(16);
+	EXPECT_TRUE(q.try_push(1)); // armed at start - signals once
+	EXPECT_TRUE(q.try_push(2));
+	EXPECT_TRUE(q.try_push(3));
+	EXPECT_EQ(q.signals(), 1u);
+
+	EXPECT_FALSE(q.arm()); // not empty
+	EXPECT_EQ(q.drain([](int) { }), 3u);
+	EXPECT_TRUE(q.arm());
+	EXPECT_TRUE(q.try_push(4));
+	EXPECT_EQ(q.signals(), 2u);
+}
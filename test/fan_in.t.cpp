@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "fan_in.hpp"
+
+TEST(FanIn, RegisterLimit) {
+	stel::fan_in_channel<int> ch(2, 16);
+	auto a = ch.register_producer();
+	auto b = ch.register_producer();
+	EXPECT_EQ(a.index(), 0u);
+	EXPECT_EQ(b.index(), 1u);
+	EXPECT_THROW(ch.register_producer(), std::length_error);
+	EXPECT_EQ(ch.producers(), 2u);
+}
+
+TEST(FanIn, RoundRobinIsFair) {
+	stel::fan_in_channel<int> ch(3, 16);
+	auto p0 = ch.register_producer();
+	auto p1 = ch.register_producer();
+	auto p2 = ch.register_producer();
+	for (int i = 0; i < 3; ++i) {
+		p0.try_push(i);
+		p1.try_push(100 + i);
+		p2.try_push(200 + i);
+	}
+
+	std::vector<int> got;
+	int v;
+	while (ch.try_pop(v)) got.push_back(v);
+	EXPECT_EQ(got, (std::vector<int>{0, 100, 200, 1, 101, 201, 2, 102, 202}));
+	EXPECT_FALSE(ch.try_pop(v));
+}
+
+TEST(FanIn, OldestFirst) {
+	stel::fan_in_channel<std::uint64_t> ch(2, 16);
+	auto a = ch.register_producer();
+	auto b = ch.register_producer();
+	for (std::uint64_t t : {1, 4, 5, 9}) a.try_push(t);
+	for (std::uint64_t t : {2, 3, 6, 7, 8}) b.try_push(t);
+
+	std::vector<std::uint64_t> got;
+	std::uint64_t v;
+	while (ch.try_pop_oldest(v, [](std::uint64_t x) { return x; })) got.push_back(v);
+	EXPECT_EQ(got, (std::vector<std::uint64_t>{1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(FanIn, ManyProducersNoLoss) {
+	constexpr std::size_t producers = 70; // more than one bitmap word
+	constexpr std::uint64_t per_producer = 5000;
+	stel::fan_in_channel<std::uint64_t> ch(producers, 64);
+
+	std::vector<std::thread> threads;
+	for (std::size_t p = 0; p < producers; ++p) {
+		threads.emplace_back([&ch] {
+			auto h = ch.register_producer();
+			for (std::uint64_t i = 0; i < per_producer; ++i) {
+				const std::uint64_t v = (std::uint64_t(h.index()) << 32) | i;
+				while (!h.try_push(v)) std::this_thread::yield();
+			}
+		});
+	}
+
+	std::vector<std::uint64_t> next(producers, 0);
+	std::uint64_t total = 0;
+	bool ordered = true;
+	while (total < producers * per_producer) {
+		const std::size_t n = ch.drain([&](std::uint64_t& v) {
+			const std::size_t src = v >> 32;
+			ordered &= (v & 0xffffffff) == next[src]++;
+		});
+		total += n;
+		if (n == 0) std::this_thread::yield();
+	}
+	for (auto& t : threads) t.join();
+
+	EXPECT_TRUE(ordered);
+	std::uint64_t v;
+	EXPECT_FALSE(ch.try_pop(v));
+}
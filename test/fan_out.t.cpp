@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "fan_out.hpp"
+
+TEST(FanOut, RoundRobinSkipsFullRings) {
+	stel::fan_out_dispatcher<int> d(3, 4); // 3 items per ring
+	for (int i = 0; i < 9; ++i) {
+		EXPECT_TRUE(d.try_push(i));
+	}
+	EXPECT_FALSE(d.try_push(9));
+	EXPECT_EQ(d.pushed(), (std::vector<std::uint64_t>{3, 3, 3}));
+
+	int v;
+	ASSERT_TRUE(d.try_pop(1, v));
+	EXPECT_EQ(v, 1);
+	// Only ring 1 has room now
+	EXPECT_TRUE(d.try_push(42));
+	EXPECT_EQ(d.pushed()[1], 4u);
+}
+
+TEST(FanOut, FailedPushKeepsValue) {
+	stel::fan_out_dispatcher<std::unique_ptr<int>> d(2, 2); // 1 item per ring
+	EXPECT_TRUE(d.try_push(std::make_unique<int>(1)));
+	EXPECT_TRUE(d.try_push(std::make_unique<int>(2)));
+	auto p = std::make_unique<int>(3);
+	EXPECT_FALSE(d.try_push(std::move(p))); // both rings full
+	ASSERT_NE(p, nullptr);
+	EXPECT_EQ(*p, 3);
+
+	std::unique_ptr<int> out;
+	ASSERT_TRUE(d.try_pop(1, out));
+	EXPECT_EQ(*out, 2);
+	EXPECT_TRUE(d.try_push(std::move(p)));
+	EXPECT_EQ(p, nullptr);
+	ASSERT_TRUE(d.try_pop(1, out)); // round robin wrapped past full ring 0
+	EXPECT_EQ(*out, 3);
+}
+
+TEST(FanOut, LeastOccupiedPrefersEmptyRing) {
+	stel::fan_out_dispatcher<int>::options opt;
+	opt.policy = stel::fan_out_policy::least_occupied;
+	opt.refresh = 1;
+	stel::fan_out_dispatcher<int> d(2, 16, opt);
+
+	for (int i = 0; i < 6; ++i) d.try_push(i);
+	EXPECT_EQ(d.pushed(), (std::vector<std::uint64_t>{3, 3}));
+
+	// Worker 1 catches up, the next pushes should all go its way
+	int v;
+	while (d.try_pop(1, v)) { }
+	for (int i = 0; i < 3; ++i) d.try_push(i);
+	EXPECT_EQ(d.pushed(), (std::vector<std::uint64_t>{3, 6}));
+}
+
+TEST(FanOut, KeyHashKeepsPerKeyOrder) {
+	constexpr std::size_t workers = 4;
+	constexpr std::uint64_t keys = 64;
+	constexpr std::uint64_t per_key = 2000;
+
+	stel::fan_out_dispatcher<std::uint64_t>::options opt;
+	opt.policy = stel::fan_out_policy::key_hash;
+	stel::fan_out_dispatcher<std::uint64_t> d(workers, 256, opt);
+
+	std::atomic<bool> done{false};
+	std::atomic<bool> ok{true};
+	std::vector<std::thread> threads;
+	for (std::size_t w = 0; w < workers; ++w) {
+		threads.emplace_back([&, w] {
+			std::vector<std::uint64_t> next(keys, 0);
+			auto consume = [&](std::uint64_t& v) {
+				const std::uint64_t key = v >> 32;
+				if (d.ring_for_key(key) != w || (v & 0xffffffff) != next[key]++) ok = false;
+			};
+			while (!done.load(std::memory_order_acquire)) {
+				if (d.drain(w, consume) == 0) std::this_thread::yield();
+			}
+			d.drain(w, consume, ~std::size_t(0));
+		});
+	}
+
+	for (std::uint64_t i = 0; i < per_key; ++i) {
+		for (std::uint64_t k = 0; k < keys; ++k) {
+			while (!d.try_push((k << 32) | i, k)) std::this_thread::yield();
+		}
+	}
+	done.store(true, std::memory_order_release);
+	for (auto& t : threads) t.join();
+
+	EXPECT_TRUE(ok.load());
+	std::uint64_t total = 0;
+	for (auto n : d.pushed()) total += n;
+	EXPECT_EQ(total, keys * per_key);
+}
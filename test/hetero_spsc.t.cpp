@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "hetero_spsc.hpp"
+
+namespace {
+
+struct tick { std::uint64_t ts; };
+struct alignas(32) quote { double bid, ask; std::uint32_t id; };
+struct text { std::string s; };
+
+struct counted {
+	static inline int alive = 0;
+	int v;
+	explicit counted(int x) : v(x) { ++alive; }
+	counted(const counted& o) : v(o.v) { ++alive; }
+	~counted() { --alive; }
+};
+
+using ring = stel::hetero_spsc_ring<tick, quote, text, counted>;
+
+}
+
+TEST(HeteroSpsc, RecordSizes) {
+	EXPECT_EQ(ring::record_size<tick>(), 16u);
+	EXPECT_EQ(ring::record_size<quote>(), 64u); // header, pad to 32, 32 byte payload
+	EXPECT_EQ(ring::tag_of<quote>, 1u);
+}
+
+TEST(HeteroSpsc, VisitsInOrderWithTypes) {
+	ring r(1024);
+	EXPECT_TRUE(r.try_push(tick{1}));
+	EXPECT_TRUE(r.try_emplace<quote>(quote{1.5, 2.5, 7}));
+	EXPECT_TRUE(r.try_push(text{"hello"}));
+	EXPECT_TRUE(r.try_emplace<tick>(tick{2}));
+
+	std::vector<std::string> seen;
+	struct visitor {
+		std::vector<std::string>& out;
+		void operator()(tick& t) { out.push_back("tick " + std::to_string(t.ts)); }
+		void operator()(quote& q) {
+			EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&q) % alignof(quote), 0u);
+			out.push_back("quote " + std::to_string(q.id));
+		}
+		void operator()(text& t) { out.push_back("text " + t.s); }
+		void operator()(counted&) { out.push_back("counted"); }
+	} v{seen};
+
+	EXPECT_EQ(r.consume_bulk(v, 100), 4u);
+	EXPECT_EQ(seen, (std::vector<std::string>{"tick 1", "quote 7", "text hello", "tick 2"}));
+	EXPECT_TRUE(r.empty());
+	EXPECT_FALSE(r.try_consume(v));
+}
+
+TEST(HeteroSpsc, FullAndWrap) {
+	stel::hetero_spsc_ring<tick, quote> r(128);
+	int pushed = 0;
+	while (r.try_push(tick{static_cast<std::uint64_t>(pushed)})) ++pushed;
+	EXPECT_EQ(pushed, 8); // 128 / 16
+
+	// Free two records, a 64 byte quote still doesn't fit
+	std::uint64_t next = 0;
+	auto check = [&](auto& m) {
+		if constexpr (std::is_same_v<std::remove_reference_t<decltype(m)>, tick>) {
+			EXPECT_EQ(m.ts, next);
+		}
+		++next;
+	};
+	EXPECT_EQ(r.consume_bulk(check, 2), 2u);
+	EXPECT_FALSE(r.try_push(quote{}));
+	// Free the rest: tail is exactly 128, so the quote starts at 0 with no skip record
+	EXPECT_EQ(r.consume_bulk(check, 100), 6u);
+	EXPECT_TRUE(r.try_push(quote{0, 0, 3}));
+	int quotes = 0;
+	EXPECT_TRUE(r.try_consume([&](auto& m) {
+		if constexpr (std::is_same_v<std::remove_reference_t<decltype(m)>, quote>) ++quotes;
+	}));
+	EXPECT_EQ(quotes, 1);
+}
+
+TEST(HeteroSpsc, WrapWritesSkipRecord) {
+	stel::hetero_spsc_ring<tick, quote> r(128);
+	for (std::uint64_t i = 0; i < 6; ++i) ASSERT_TRUE(r.try_push(tick{i}));
+	int ticks = 0;
+	EXPECT_EQ(r.consume_bulk([&](auto&) { ++ticks; }, 100), 6u);
+	EXPECT_EQ(ticks, 6);
+
+	// tail is at 96: the quote's payload would end at 160, so the last 32 bytes
+	// become a skip record and the quote starts at 0
+	EXPECT_TRUE(r.try_push(quote{1.5, 2.5, 7}));
+	EXPECT_EQ(r.maybe_used_bytes(), 32u + ring::record_size<quote>());
+
+	std::uint32_t id = 0;
+	int seen = 0;
+	EXPECT_EQ(r.consume_bulk([&](auto& m) {
+		++seen;
+		if constexpr (std::is_same_v<std::remove_reference_t<decltype(m)>, quote>) id = m.id;
+	}, 100), 1u); // the skip record isn't handed out
+	EXPECT_EQ(seen, 1);
+	EXPECT_EQ(id, 7u);
+	EXPECT_TRUE(r.empty());
+}
+
+TEST(HeteroSpsc, DestroysLeftovers) {
+	{
+		ring r(256);
+		for (int i = 0; i < 5; ++i) r.try_emplace<counted>(i);
+		EXPECT_EQ(counted::alive, 5);
+		r.try_consume([](auto&) { });
+		EXPECT_EQ(counted::alive, 4);
+	}
+	EXPECT_EQ(counted::alive, 0);
+}
+
+TEST(HeteroSpsc, ThrowingVisitor) {
+	{
+		ring r(256);
+		for (int i = 0; i < 3; ++i) r.try_emplace<counted>(i);
+
+		std::vector<int> seen;
+		EXPECT_THROW(r.consume_bulk([&](auto& m) {
+			if constexpr (std::is_same_v<std::remove_cvref_t<decltype(m)>, counted>) {
+				seen.push_back(m.v);
+				if (m.v == 1) throw std::runtime_error("boom");
+			}
+		}, 10), std::runtime_error);
+		// The one that threw is destroyed and released too
+		EXPECT_EQ(counted::alive, 1);
+
+		r.try_consume([&](auto& m) {
+			if constexpr (std::is_same_v<std::remove_cvref_t<decltype(m)>, counted>) {
+				seen.push_back(m.v);
+			}
+		});
+		EXPECT_EQ(seen, (std::vector<int>{0, 1, 2}));
+		EXPECT_TRUE(r.empty());
+	}
+	EXPECT_EQ(counted::alive, 0);
+}
+
+TEST(HeteroSpsc, ProducerConsumer) {
+	constexpr std::uint64_t count = 200000;
+	stel::hetero_spsc_ring<tick, quote, text> r(4096);
+
+	std::thread producer([&] {
+		for (std::uint64_t i = 0; i < count; ++i) {
+			switch (i % 3) {
+			case 0: while (!r.try_push(tick{i})) { std::this_thread::yield(); } break;
+			case 1: while (!r.try_push(quote{0, 0, static_cast<std::uint32_t>(i)})) { std::this_thread::yield(); } break;
+			case 2: while (!r.try_push(text{std::to_string(i)})) { std::this_thread::yield(); } break;
+			}
+		}
+	});
+
+	std::uint64_t next = 0;
+	bool ok = true;
+	struct visitor {
+		std::uint64_t& next;
+		bool& ok;
+		void operator()(tick& t) { ok &= next % 3 == 0 && t.ts == next; ++next; }
+		void operator()(quote& q) { ok &= next % 3 == 1 && q.id == next; ++next; }
+		void operator()(text& t) { ok &= next % 3 == 2 && t.s == std::to_string(next); ++next; }
+	} v{next, ok};
+	while (next < count) {
+		if (r.consume_bulk(v, 32) == 0) std::this_thread::yield();
+	}
+	producer.join();
+	EXPECT_TRUE(ok);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "lock_free_mpmc_bounded.hpp"
+
+TEST(MPMCBounded, EmptyAndFull) {
+	mpmc_bounded_queue<int> q(4);
+	int out = 0;
+	EXPECT_FALSE(q.try_dequeue(out));
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(q.try_enqueue(i));
+	}
+	EXPECT_FALSE(q.try_enqueue(4));
+	EXPECT_EQ(q.maybe_size(), 4u);
+}
+
+TEST(MPMCBounded, PrefetchWraps) {
+	mpmc_bounded_queue<std::uint64_t> q(8, 5);
+	EXPECT_EQ(q.prefetch_distance(), 5u);
+	std::uint64_t out = 0;
+	for (std::uint64_t i = 0; i < 100; ++i) {
+		ASSERT_TRUE(q.try_enqueue(i));
+		ASSERT_TRUE(q.try_dequeue(out));
+		EXPECT_EQ(out, i);
+	}
+}
+
+TEST(MPMCBounded, FailedPollsDontCorrupt) {
+	// Polling an empty (or full) queue must not consume a ticket
+	mpmc_bounded_queue<int> q(4);
+	int out = 0;
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_FALSE(q.try_dequeue(out));
+	}
+	EXPECT_TRUE(q.try_enqueue(42));
+	ASSERT_TRUE(q.try_dequeue(out));
+	EXPECT_EQ(out, 42);
+
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(q.try_enqueue(i));
+	}
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_FALSE(q.try_enqueue(100));
+	}
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(q.try_dequeue(out));
+		EXPECT_EQ(out, i);
+	}
+	EXPECT_TRUE(q.empty_hint());
+}
+
+TEST(MPMCBounded, ConcurrentProducersConsumers) {
+	constexpr int producers = 4;
+	constexpr int consumers = 4;
+	constexpr int per_producer = 20000;
+
+	mpmc_bounded_queue<int> q(64);
+	std::atomic<long long> sum{0};
+	std::atomic<int> consumed{0};
+
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p) {
+		threads.emplace_back([&] {
+			for (int i = 1; i <= per_producer; ++i) {
+				while (!q.try_enqueue(i)) std::this_thread::yield();
+			}
+		});
+	}
+	for (int c = 0; c < consumers; ++c) {
+		threads.emplace_back([&] {
+			int v = 0;
+			while (consumed.load() < producers * per_producer) {
+				if (q.try_dequeue(v)) {
+					sum.fetch_add(v);
+					consumed.fetch_add(1);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (auto& t : threads) t.join();
+
+	const long long expected = 1LL * producers * per_producer * (per_producer + 1) / 2;
+	EXPECT_EQ(sum.load(), expected);
+}
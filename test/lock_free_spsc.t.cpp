@@ -1,4 +1,9 @@
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
 #include "lock_free_spsc.hpp"
 
 TEST(LockFreeSPSC, QueueIsEmpty) {
@@ -75,4 +80,67 @@ TEST(LockFreeSPSC, PushAndPopMultipleValues_2) {
 	EXPECT_TRUE(q.empty());
 }
 
+TEST(LockFreeSPSC, PrefetchDoesNotChangeBehaviour) {
+	struct big { std::uint64_t v; char pad[504]; };
+	lock_free_spsc_queue<big> q(8, stel::default_prefetch_distance(sizeof(big)));
+	EXPECT_EQ(q.prefetch_distance(), 2u);
+
+	std::uint64_t next_in = 0, next_out = 0;
+	for (int round = 0; round < 10; ++round) {
+		while (q.try_push(big{next_in, {}})) ++next_in;
+		big out;
+		while (q.try_pop(out)) EXPECT_EQ(out.v, next_out++);
+	}
+	EXPECT_EQ(next_in, next_out);
+	EXPECT_EQ(next_in, 70u);
+
+	// Distance is clamped below the capacity
+	lock_free_spsc_queue<int> small(4, 100);
+	EXPECT_EQ(small.prefetch_distance(), 3u);
+}
+
+TEST(LockFreeSPSC, PopBulk) {
+	lock_free_spsc_queue<int> q(8);
+	for (int i = 0; i < 5; ++i) EXPECT_TRUE(q.try_push(i));
+
+	std::vector<int> out;
+	EXPECT_EQ(q.pop_bulk([&](int& v) { out.push_back(v); }, 3), 3u);
+	EXPECT_EQ(q.pop_bulk([&](int& v) { out.push_back(v); }, 10), 2u);
+	EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4}));
+	EXPECT_TRUE(q.empty());
+}
 
+TEST(LockFreeSPSC, PushBulk) {
+	lock_free_spsc_queue<std::unique_ptr<int>> q(8); // 7 usable slots
+	std::vector<std::unique_ptr<int>> in;
+	for (int i = 0; i < 10; ++i) in.push_back(std::make_unique<int>(i));
+
+	EXPECT_EQ(q.push_bulk(in.data(), 4), 4u);
+	EXPECT_EQ(q.push_bulk(in.data() + 4, 6), 3u); // only 3 fit
+	EXPECT_NE(in[7], nullptr); // not pushed, not moved from
+	EXPECT_EQ(q.push_bulk(in.data() + 7, 3), 0u);
+
+	std::vector<int> out;
+	q.pop_bulk([&](std::unique_ptr<int>& v) { out.push_back(*v); }, 10);
+	EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4, 5, 6}));
+	EXPECT_EQ(q.push_bulk(in.data() + 7, 3), 3u);
+	EXPECT_EQ(q.maybe_size(), 3u);
+}
+
+TEST(LockFreeSPSC, PopBulkThrowingCallback) {
+	lock_free_spsc_queue<std::shared_ptr<int>> q(8);
+	auto tracked = std::make_shared<int>(0);
+	for (int i = 0; i < 5; ++i) EXPECT_TRUE(q.try_push(tracked));
+	EXPECT_EQ(tracked.use_count(), 6);
+
+	int seen = 0;
+	EXPECT_THROW(q.pop_bulk([&](std::shared_ptr<int>&) {
+		if (++seen == 3) throw std::runtime_error("boom");
+	}, 10), std::runtime_error);
+
+	// Two consumed, the one that threw and the rest still queued - each destroyed once
+	EXPECT_EQ(tracked.use_count(), 4);
+	EXPECT_EQ(q.maybe_size(), 3u);
+	EXPECT_EQ(q.pop_bulk([](std::shared_ptr<int>&) { }, 10), 3u);
+	EXPECT_EQ(tracked.use_count(), 1);
+}
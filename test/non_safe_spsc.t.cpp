@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <string>
 #include "non_safe_spsc.hpp"
 
 TEST(NonSafeSPSC, QueueIsEmpty) {
@@ -73,4 +74,18 @@ TEST(NonSafeSPSC, PushAndPopMultipleValues_2) {
 	EXPECT_TRUE(q.empty());
 }
 
+TEST(NonSafeSPSC, PeekWithoutCopy) {
+	spsc_queue<std::string, 4> q;
+	EXPECT_EQ(q.peek(), nullptr);
+	EXPECT_TRUE(q.try_push(std::string(100, 'x')));
+	EXPECT_TRUE(q.try_push("b"));
 
+	ASSERT_NE(q.peek(), nullptr);
+	std::string s = std::move(*q.peek());
+	EXPECT_EQ(s, std::string(100, 'x'));
+	EXPECT_TRUE(q.try_pop());
+	ASSERT_NE(q.peek(), nullptr);
+	EXPECT_EQ(*q.peek(), "b");
+	EXPECT_TRUE(q.try_pop());
+	EXPECT_EQ(q.peek(), nullptr);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "object_pool.hpp"
+
+namespace {
+
+struct tracked {
+	static inline std::atomic<int> alive{0};
+	int value;
+	explicit tracked(int v) : value(v) {
+		if (v < 0) throw std::invalid_argument("tracked: negative");
+		alive.fetch_add(1);
+	}
+	~tracked() { alive.fetch_sub(1); }
+};
+
+}
+
+TEST(ObjectPool, SlotsAreCacheAligned) {
+	stel::object_pool<tracked> pool(8);
+	tracked* a = pool.acquire(1);
+	tracked* b = pool.acquire(2);
+	ASSERT_NE(a, nullptr);
+	ASSERT_NE(b, nullptr);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a) % 64, 0u);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b) % 64, 0u);
+	pool.release(a);
+	pool.release(b);
+}
+
+TEST(ObjectPool, ExhaustAndRelease) {
+	stel::object_pool<tracked> pool(4);
+	std::vector<tracked*> objs;
+	for (int i = 0; i < 4; ++i) {
+		objs.push_back(pool.acquire(i));
+		ASSERT_NE(objs.back(), nullptr);
+		EXPECT_EQ(objs.back()->value, i);
+	}
+	EXPECT_EQ(pool.acquire(99), nullptr);
+	EXPECT_EQ(tracked::alive.load(), 4);
+
+	for (auto* o : objs) pool.release(o);
+	EXPECT_EQ(tracked::alive.load(), 0);
+	tracked* again = pool.acquire(5);
+	ASSERT_NE(again, nullptr);
+	pool.release(again);
+}
+
+TEST(ObjectPool, CacheReturnsOnDestruction) {
+	stel::object_pool<tracked> pool(16);
+	{
+		stel::object_pool<tracked>::cache c(pool, 8);
+		tracked* t = c.acquire(1);
+		ASSERT_NE(t, nullptr);
+		EXPECT_EQ(c.size(), 3u); // refilled half a magazine, handed one out
+		c.release(t);
+	}
+	EXPECT_EQ(pool.maybe_free(), 16u);
+}
+
+TEST(ObjectPool, ThrowingConstructorKeepsTheSlot) {
+	stel::object_pool<tracked> pool(2);
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_THROW(pool.acquire(-1), std::invalid_argument);
+	}
+	EXPECT_EQ(pool.maybe_free(), 2u);
+
+	{
+		stel::object_pool<tracked>::cache c(pool, 4);
+		for (int i = 0; i < 4; ++i) {
+			EXPECT_THROW(c.acquire(-1), std::invalid_argument);
+		}
+		EXPECT_EQ(c.size(), 2u);
+		tracked* a = c.acquire(1);
+		tracked* b = c.acquire(2);
+		ASSERT_NE(a, nullptr);
+		ASSERT_NE(b, nullptr);
+		c.release(a);
+		c.release(b);
+	}
+	EXPECT_EQ(pool.maybe_free(), 2u);
+	EXPECT_EQ(tracked::alive.load(), 0);
+}
+
+TEST(ObjectPool, ConcurrentCachesNeverShareObjects) {
+	constexpr int threads = 4;
+	constexpr int rounds = 20000;
+	stel::object_pool<tracked> pool(256);
+	std::atomic<int> collisions{0};
+
+	std::vector<std::thread> ts;
+	for (int t = 0; t < threads; ++t) {
+		ts.emplace_back([&, t] {
+			stel::object_pool<tracked>::cache c(pool, 16);
+			std::vector<tracked*> held;
+			for (int i = 0; i < rounds; ++i) {
+				if (tracked* o = c.acquire(t)) {
+					held.push_back(o);
+				}
+				if (held.size() > 20 || (i & 1)) {
+					for (auto* o : held) {
+						if (o->value != t) collisions.fetch_add(1);
+						c.release(o);
+					}
+					held.clear();
+				}
+			}
+			for (auto* o : held) c.release(o);
+		});
+	}
+	for (auto& t : ts) t.join();
+
+	EXPECT_EQ(collisions.load(), 0);
+	EXPECT_EQ(tracked::alive.load(), 0);
+	EXPECT_EQ(pool.maybe_free(), 256u);
+}
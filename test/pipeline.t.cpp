@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "pipeline.hpp"
+
+TEST(Pipeline, LinearChainKeepsOrder) {
+	stel::pipeline<std::uint64_t>::options opt;
+	opt.ring_capacity = 64;
+	opt.batch = 8;
+	opt.pin = false;
+
+	std::uint64_t next = 0;
+	std::uint64_t expected = 0;
+	bool in_order = true;
+
+	stel::pipeline<std::uint64_t> p(opt);
+	p.source("gen", [&](std::uint64_t& out) {
+		if (next == 10000) return false;
+		out = next++;
+		return true;
+	})
+	.stage("double", [](std::uint64_t& v) { v *= 2; })
+	.stage("check", [&](std::uint64_t& v) {
+		if (v != expected) in_order = false;
+		expected += 2;
+	});
+	p.run();
+
+	EXPECT_TRUE(in_order);
+	EXPECT_EQ(expected, 20000u);
+
+	const auto st = p.stats();
+	ASSERT_EQ(st.size(), 3u);
+	for (const auto& s : st) {
+		EXPECT_EQ(s.items, 10000u);
+	}
+}
+
+TEST(Pipeline, ParallelStageFansOutAndIn) {
+	stel::pipeline<std::uint64_t>::options opt;
+	opt.ring_capacity = 64;
+	opt.pin = false;
+
+	std::uint64_t next = 1;
+	std::atomic<std::uint64_t> middle_sum{0};
+	std::uint64_t sink_sum = 0;
+
+	stel::pipeline<std::uint64_t> p(opt);
+	p.source("gen", [&](std::uint64_t& out) {
+		if (next > 5000) return false;
+		out = next++;
+		return true;
+	})
+	.stage("work", [&](std::uint64_t& v) { middle_sum.fetch_add(v); }, 3)
+	.stage("sink", [&](std::uint64_t& v) { sink_sum += v; });
+	p.run();
+
+	EXPECT_EQ(middle_sum.load(), 5000u * 5001 / 2);
+	EXPECT_EQ(sink_sum, 5000u * 5001 / 2);
+	EXPECT_EQ(p.stats()[1].workers, 3u);
+}
+
+TEST(Pipeline, BackPressureKeepsNonTrivialItems) {
+	stel::pipeline<std::string>::options opt;
+	opt.ring_capacity = 4; // smaller than a batch, so pushes hit full rings
+	opt.batch = 8;
+	opt.pin = false;
+
+	constexpr int count = 20000;
+	int next = 0;
+	int received = 0;
+	int empty = 0;
+	std::uint64_t sum = 0;
+
+	stel::pipeline<std::string> p(opt);
+	p.source("gen", [&](std::string& out) {
+		if (next == count) return false;
+		out = "item-" + std::to_string(next++);
+		return true;
+	})
+	.stage("pass", [](std::string&) { }, 2)
+	.stage("sink", [&](std::string& s) {
+		++received;
+		if (s.size() <= 5) { ++empty; return; }
+		sum += std::stoull(s.substr(5));
+	});
+	p.run();
+
+	EXPECT_EQ(received, count);
+	EXPECT_EQ(empty, 0);
+	EXPECT_EQ(sum, std::uint64_t(count) * (count - 1) / 2);
+}
+
+TEST(Pipeline, ZeroBatchStillRuns) {
+	stel::pipeline<int>::options opt;
+	opt.batch = 0; // clamped to 1, must not spin forever
+	opt.pin = false;
+
+	int next = 0;
+	int sum = 0;
+	stel::pipeline<int> p(opt);
+	p.source("gen", [&](int& out) {
+		if (next == 100) return false;
+		out = next++;
+		return true;
+	})
+	.stage("sum", [&](int& v) { sum += v; });
+	p.run();
+
+	EXPECT_EQ(sum, 4950);
+}
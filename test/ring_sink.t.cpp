@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ring_sink.hpp"
+
+namespace {
+
+struct rec {
+	std::uint64_t seq;
+	std::uint64_t payload[2];
+};
+
+void sink_and_verify(bool direct) {
+	char name[] = "/tmp/ring_sink_XXXXXX";
+	const int tmp = ::mkstemp(name);
+	::close(tmp);
+	constexpr std::uint64_t count = 100003; // leaves an unaligned tail
+
+	lock_free_spsc_queue<rec> ring(1024);
+	{
+		stel::ring_sink<rec>::options opt;
+		opt.buffer_bytes = 64 * 1024;
+		opt.direct = direct;
+		stel::ring_sink<rec> sink(ring, name, opt);
+
+		for (std::uint64_t i = 0; i < count; ++i) {
+			while (!ring.try_push(rec{i, {i * 3, i * 5}})) std::this_thread::yield();
+		}
+		sink.stop();
+		EXPECT_EQ(sink.error(), 0);
+	}
+
+	struct stat st;
+	ASSERT_EQ(::stat(name, &st), 0);
+	EXPECT_EQ(static_cast<std::uint64_t>(st.st_size), count * sizeof(rec));
+
+	std::FILE* f = std::fopen(name, "rb");
+	ASSERT_NE(f, nullptr);
+	rec r;
+	std::uint64_t i = 0;
+	while (std::fread(&r, sizeof(r), 1, f) == 1) {
+		ASSERT_EQ(r.seq, i);
+		ASSERT_EQ(r.payload[1], i * 5);
+		++i;
+	}
+	EXPECT_EQ(i, count);
+	std::fclose(f);
+	::unlink(name);
+}
+
+}
+
+TEST(RingSink, BufferedWritesEverythingInOrder) {
+	sink_and_verify(false);
+}
+
+TEST(RingSink, DirectWritesEverythingInOrder) {
+	// Falls back to buffered writes if /tmp refuses O_DIRECT
+	sink_and_verify(true);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "bounded_mpmc_pool.hpp"
+#include "thread_pool.hpp"
+
+TEST(BoundedPool, WaitIdleRunsEverything) {
+	stel::bounded_mpmc_pool pool(4, 1024);
+	std::atomic<int> done{0};
+	for (int i = 0; i < 500; ++i) {
+		EXPECT_TRUE(pool.submit([&] { done.fetch_add(1); }));
+	}
+	pool.wait_idle();
+	EXPECT_EQ(done.load(), 500);
+	EXPECT_EQ(pool.pending(), 0u);
+}
+
+TEST(BoundedPool, DrainFinishesQueuedTasks) {
+	stel::bounded_mpmc_pool pool(2, 256);
+	std::atomic<int> done{0};
+	for (int i = 0; i < 100; ++i) {
+		pool.submit([&] {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+			done.fetch_add(1);
+		});
+	}
+	pool.drain();
+	EXPECT_EQ(done.load(), 100);
+}
+
+TEST(BoundedPool, RejectsAfterDrain) {
+	stel::bounded_mpmc_pool pool(2, 16);
+	pool.drain();
+	EXPECT_FALSE(pool.submit([] {}));
+	pool.wait_idle(); // must not hang
+}
+
+TEST(BoundedPool, ShutdownWithSubmittersLeavesNothingPending) {
+	for (int round = 0; round < 20; ++round) {
+		stel::bounded_mpmc_pool pool(2, 64);
+		std::atomic<bool> go{true};
+		std::atomic<int> accepted{0};
+		std::atomic<int> ran{0};
+		std::vector<std::thread> submitters;
+		for (int t = 0; t < 3; ++t) {
+			submitters.emplace_back([&] {
+				while (go.load()) {
+					if (pool.submit([&] { ran.fetch_add(1); std::this_thread::yield(); })) {
+						accepted.fetch_add(1);
+					}
+				}
+			});
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		pool.shutdown();
+		go = false;
+		for (auto& t : submitters) t.join();
+		EXPECT_EQ(pool.pending(), 0u);
+		pool.wait_idle(); // must not hang
+
+		// true only means queued: shutdown() may drop accepted tasks, never run extra ones
+		EXPECT_LE(ran.load(), accepted.load());
+		EXPECT_FALSE(pool.submit([] {}));
+	}
+}
+
+TEST(ThreadPool, WaitIdleRunsEverything) {
+	stel::thread_pool pool(4);
+	std::atomic<int> done{0};
+	for (int i = 0; i < 500; ++i) {
+		EXPECT_TRUE(pool.submit([&] { done.fetch_add(1); }));
+	}
+	pool.wait_idle();
+	EXPECT_EQ(done.load(), 500);
+}
+
+TEST(ThreadPool, WaitIdleSingleWorkerManyRounds) {
+	// One worker, so a lost wakeup between its empty check and cv wait would
+	// leave the task queued and wait_idle() blocked forever
+	stel::thread_pool pool(1);
+	std::atomic<int> done{0};
+	for (int round = 0; round < 20000; ++round) {
+		ASSERT_TRUE(pool.submit([&] { done.fetch_add(1); }));
+		pool.wait_idle();
+		ASSERT_EQ(done.load(), round + 1);
+	}
+	pool.drain();
+}
+
+TEST(ThreadPool, DrainFinishesQueuedTasks) {
+	stel::thread_pool pool(2);
+	std::atomic<int> done{0};
+	for (int i = 0; i < 100; ++i) {
+		pool.submit([&] {
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+			done.fetch_add(1);
+		});
+	}
+	pool.drain();
+	EXPECT_EQ(done.load(), 100);
+	EXPECT_FALSE(pool.submit([] {}));
+}
+
+TEST(ThreadPool, SubmitRacingShutdownLeavesNothingPending) {
+	// Copying the callable into a Task happens after submit() checked accepting_,
+	// so a slow copy holds the submitter right inside the window
+	struct slow_copy {
+		std::atomic<bool>* entered;
+		std::atomic<bool>* release;
+		slow_copy(std::atomic<bool>* e, std::atomic<bool>* r) : entered(e), release(r) { }
+		slow_copy(const slow_copy& o) : entered(o.entered), release(o.release) {
+			entered->store(true);
+			while (!release->load()) std::this_thread::yield();
+		}
+		void operator()() const { }
+	};
+
+	stel::thread_pool pool(2);
+	std::atomic<bool> entered{false};
+	std::atomic<bool> release{false};
+	bool accepted = true;
+	std::thread submitter([&] {
+		const slow_copy f(&entered, &release);
+		accepted = pool.submit(f);
+	});
+	while (!entered.load()) std::this_thread::yield();
+
+	pool.shutdown();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let the workers exit
+	release = true;
+	submitter.join();
+
+	EXPECT_FALSE(accepted);
+	ASSERT_EQ(pool.pending(), 0u);
+	pool.wait_idle(); // must not hang
+}
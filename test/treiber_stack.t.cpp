@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "treiber_stack.hpp"
+
+TEST(TreiberStack, Lifo) {
+	stel::index_stack s(8);
+	std::uint32_t v;
+	EXPECT_FALSE(s.try_pop(v));
+	s.push(3);
+	s.push(5);
+	s.push(1);
+	EXPECT_EQ(s.maybe_size(), 3u);
+	ASSERT_TRUE(s.try_pop(v)); EXPECT_EQ(v, 1u);
+	ASSERT_TRUE(s.try_pop(v)); EXPECT_EQ(v, 5u);
+	s.push(7);
+	ASSERT_TRUE(s.try_pop(v)); EXPECT_EQ(v, 7u);
+	ASSERT_TRUE(s.try_pop(v)); EXPECT_EQ(v, 3u);
+	EXPECT_FALSE(s.try_pop(v));
+	EXPECT_TRUE(s.empty_hint());
+}
+
+TEST(TreiberStack, StartsFull) {
+	stel::index_stack s(4, true);
+	EXPECT_EQ(s.maybe_size(), 4u);
+	std::uint32_t v;
+	for (std::uint32_t i = 0; i < 4; ++i) {
+		ASSERT_TRUE(s.try_pop(v));
+		EXPECT_EQ(v, i);
+	}
+	EXPECT_FALSE(s.try_pop(v));
+}
+
+// Every thread pops an index, marks it owned, then pushes it back. Two threads
+// holding the same index at once means ABA (or elimination) went wrong.
+static void hammer(stel::index_stack::options opt) {
+	constexpr std::size_t count = 64;
+	constexpr int threads = 8;
+	constexpr int rounds = 50000;
+	stel::index_stack s(count, true, opt);
+	auto owner = std::make_unique<std::atomic<int>[]>(count);
+	std::atomic<int> collisions{0};
+
+	std::vector<std::thread> ts;
+	for (int t = 0; t < threads; ++t) {
+		ts.emplace_back([&, t] {
+			std::vector<std::uint32_t> held;
+			for (int i = 0; i < rounds; ++i) {
+				std::uint32_t v;
+				if (s.try_pop(v)) {
+					if (owner[v].exchange(t + 1) != 0) collisions.fetch_add(1);
+					held.push_back(v);
+				}
+				if (held.size() > 3 || (i & 1)) {
+					for (auto h : held) {
+						owner[h].store(0);
+						s.push(h);
+					}
+					held.clear();
+				}
+			}
+			for (auto h : held) {
+				owner[h].store(0);
+				s.push(h);
+			}
+		});
+	}
+	for (auto& t : ts) t.join();
+
+	EXPECT_EQ(collisions.load(), 0);
+	EXPECT_EQ(s.maybe_size(), count);
+	std::vector<bool> seen(count, false);
+	std::uint32_t v;
+	while (s.try_pop(v)) {
+		EXPECT_FALSE(seen[v]);
+		seen[v] = true;
+	}
+}
+
+TEST(TreiberStack, ConcurrentWithElimination) {
+	hammer({});
+}
+
+TEST(TreiberStack, ConcurrentWithoutElimination) {
+	stel::index_stack::options opt;
+	opt.elimination_slots = 0;
+	hammer(opt);
+}
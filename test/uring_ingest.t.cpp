@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "uring_ingest.hpp"
+
+namespace {
+
+// Temp file with a byte pattern that makes misplaced chunks visible
+struct temp_file {
+	std::string path;
+	explicit temp_file(std::size_t size) {
+		char name[] = "/tmp/uring_ingest_XXXXXX";
+		const int fd = ::mkstemp(name);
+		path = name;
+		std::vector<unsigned char> data(size);
+		for (std::size_t i = 0; i < size; ++i) {
+			data[i] = static_cast<unsigned char>((i * 131) ^ (i >> 8));
+		}
+		EXPECT_EQ(::write(fd, data.data(), size), static_cast<ssize_t>(size));
+		::close(fd);
+	}
+	~temp_file() { ::unlink(path.c_str()); }
+};
+
+void read_back(const char* path, std::size_t size, bool uring) {
+	stel::file_ingest::options opt;
+	opt.chunk_size = 4096 * 3;
+	opt.chunks = 4;
+	opt.use_uring = uring;
+	stel::file_ingest in(path, opt);
+
+	std::uint64_t expected_offset = 0;
+	stel::ingest_chunk c;
+	while (in.next(c)) {
+		ASSERT_EQ(c.offset, expected_offset);
+		for (std::size_t i = 0; i < c.size; ++i) {
+			const std::size_t pos = c.offset + i;
+			ASSERT_EQ(static_cast<unsigned char>(c.data[i]),
+					static_cast<unsigned char>((pos * 131) ^ (pos >> 8)));
+		}
+		expected_offset += c.size;
+		in.release(c);
+	}
+	EXPECT_EQ(in.error(), 0);
+	EXPECT_EQ(expected_offset, size);
+	EXPECT_TRUE(in.finished());
+	if (!uring) {
+		EXPECT_FALSE(in.using_uring());
+	} else if (!in.using_uring()) {
+		GTEST_SKIP() << "io_uring unavailable here, only the pread fallback ran";
+	}
+}
+
+}
+
+TEST(FileIngest, PreadFallbackReadsWholeFileInOrder) {
+	temp_file f(200 * 1000 + 17);
+	read_back(f.path.c_str(), 200 * 1000 + 17, false);
+}
+
+TEST(FileIngest, UringReadsWholeFileInOrder) {
+	temp_file f(200 * 1000 + 17);
+	read_back(f.path.c_str(), 200 * 1000 + 17, true);
+}
+
+TEST(FileIngest, RecordsNeverStraddleChunks) {
+	temp_file f(100 * 48);
+	stel::file_ingest::options opt;
+	opt.chunk_size = 1000;
+	opt.record_size = 48;
+	stel::file_ingest in(f.path.c_str(), opt);
+	EXPECT_EQ(in.chunk_size(), 960u);
+
+	stel::ingest_chunk c;
+	while (in.next(c)) {
+		EXPECT_EQ(c.size % 48, 0u);
+		in.release(c);
+	}
+}
+
+TEST(FileIngest, EmptyFile) {
+	temp_file f(0);
+	stel::file_ingest in(f.path.c_str());
+	stel::ingest_chunk c;
+	EXPECT_FALSE(in.next(c));
+}
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""Benchmark baselines and regression checks for the bench/ executables.
+
+    bench_compare.py baseline --build-dir build          # run, save as this host's baseline
+    bench_compare.py compare  --build-dir build          # run, compare against it
+    bench_compare.py compare  --current run.json         # compare a saved run instead
+
+Every benchmark is run with --benchmark_repetitions and JSON output. A baseline
+is stored per host fingerprint (host name, CPU model, CPU count) so numbers from
+different machines are never compared with each other.
+
+Each benchmark's repetitions are compared with a two-sided Mann-Whitney U test:
+no normality assumption, and one noisy repetition can't drag the result the way
+it drags a mean. A benchmark is flagged only if the change is both significant
+(p < --alpha) and larger than --threshold (relative change of the median), so
+small but real differences and big but noisy ones are both left alone.
+
+Exits with 1 if anything regressed. Standard library only, no network.
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import os
+import platform
+import re
+import socket
+import subprocess
+import sys
+import tempfile
+
+TIME_TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+# ---- host --------------------------------------------------------------------
+
+def cpu_model():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name") or line.startswith("Model"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or platform.machine()
+
+
+def host_fingerprint():
+    desc = {
+        "host": socket.gethostname(),
+        "cpu": cpu_model(),
+        "cpus": os.cpu_count() or 0,
+        "machine": platform.machine(),
+    }
+    key = json.dumps(desc, sort_keys=True).encode()
+    return hashlib.sha1(key).hexdigest()[:12], desc
+
+
+# ---- running -----------------------------------------------------------------
+
+def bench_executables(build_dir, bench_dir):
+    names = sorted(os.path.splitext(f)[0] for f in os.listdir(bench_dir)
+                   if f.endswith((".cpp", ".cxx", ".cc")))
+    exes = []
+    for name in names:
+        path = os.path.join(build_dir, name)
+        if os.access(path, os.X_OK):
+            exes.append(path)
+        else:
+            print(f"warning: {name} not built, skipped", file=sys.stderr)
+    return exes
+
+
+def run_benchmarks(exes, repetitions, bench_filter, extra_args):
+    """Returns {benchmark name: [per-repetition values]} plus the metric it used."""
+    results = {}
+    for exe in exes:
+        with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as tmp:
+            out = tmp.name
+        cmd = [exe,
+               f"--benchmark_repetitions={repetitions}",
+               "--benchmark_out_format=json",
+               f"--benchmark_out={out}"]
+        if bench_filter:
+            cmd.append(f"--benchmark_filter={bench_filter}")
+        cmd += extra_args
+        print(f"running {os.path.basename(exe)}", file=sys.stderr)
+        proc = subprocess.run(cmd, stdout=subprocess.DEVNULL)
+        try:
+            if proc.returncode != 0:
+                print(f"warning: {exe} exited with {proc.returncode}", file=sys.stderr)
+            with open(out) as f:
+                data = json.load(f)
+        except (OSError, json.JSONDecodeError):
+            continue
+        finally:
+            if os.path.exists(out):
+                os.unlink(out)
+        for b in data.get("benchmarks", []):
+            if b.get("run_type", "iteration") != "iteration" or b.get("error_occurred"):
+                continue
+            name = f"{os.path.basename(exe)}:{b.get('run_name', b['name'])}"
+            entry = results.setdefault(name, {})
+            entry.setdefault("real_time_ns", []).append(
+                b["real_time"] * TIME_TO_NS.get(b.get("time_unit", "ns"), 1.0))
+            for key, value in b.items():
+                if isinstance(value, (int, float)) and key.endswith("per_second"):
+                    entry.setdefault(key, []).append(float(value))
+    return results
+
+
+# ---- statistics --------------------------------------------------------------
+
+def ranks(values):
+    """Midranks (1-based) for values, ties share the average rank."""
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    r = [0.0] * len(values)
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            r[order[k]] = (i + j) / 2.0 + 1.0
+        i = j + 1
+    return r
+
+
+def mann_whitney_p(a, b):
+    """Two-sided p-value of the Mann-Whitney U test for samples a and b.
+
+    Exact (distribution of rank sums counted over all splits, ties included) for
+    small samples, which is the usual case with a handful of repetitions;
+    normal approximation with tie correction above that.
+    """
+    n1, n2 = len(a), len(b)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    r = ranks(list(a) + list(b))
+    n = n1 + n2
+    u1 = sum(r[:n1]) - n1 * (n1 + 1) / 2.0
+    mean = n1 * n2 / 2.0
+
+    if n <= 40:
+        # Midranks are multiples of 1/2, count subsets of size n1 by doubled rank sum
+        doubled = [int(round(x * 2)) for x in r]
+        total = sum(doubled)
+        ways = [[0] * (total + 1) for _ in range(n1 + 1)]
+        ways[0][0] = 1
+        for d in doubled:
+            for k in range(n1, 0, -1):
+                row, prev = ways[k], ways[k - 1]
+                for s in range(total, d - 1, -1):
+                    if prev[s - d]:
+                        row[s] += prev[s - d]
+        count = sum(ways[n1])
+        offset = n1 * (n1 + 1)  # doubled minimum rank sum
+        observed = abs(u1 - mean)
+        extreme = 0
+        for s, c in enumerate(ways[n1]):
+            if c and abs((s - offset) / 2.0 - mean) >= observed - 1e-9:
+                extreme += c
+        return min(1.0, extreme / count)
+
+    ties = {}
+    for x in r:
+        ties[x] = ties.get(x, 0) + 1
+    tie_term = sum(t ** 3 - t for t in ties.values()) / (n * (n - 1))
+    sigma = math.sqrt(n1 * n2 / 12.0 * ((n + 1) - tie_term))
+    if sigma == 0:
+        return 1.0
+    z = (abs(u1 - mean) - 0.5) / sigma
+    return min(1.0, math.erfc(max(z, 0.0) / math.sqrt(2)))
+
+
+def median(xs):
+    s = sorted(xs)
+    m = len(s) // 2
+    return s[m] if len(s) % 2 else (s[m - 1] + s[m]) / 2.0
+
+
+# ---- baseline store ----------------------------------------------------------
+
+def baseline_path(store, fingerprint):
+    return os.path.join(store, f"{fingerprint}.json")
+
+
+def load(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def save(path, doc):
+    os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+    with open(path, "w") as f:
+        json.dump(doc, f, indent=1, sort_keys=True)
+
+
+# ---- report ------------------------------------------------------------------
+
+def human(v):
+    for unit, scale in (("G", 1e9), ("M", 1e6), ("k", 1e3)):
+        if abs(v) >= scale:
+            return f"{v / scale:.3g}{unit}"
+    return f"{v:.3g}"
+
+
+def compare(base, cur, metric, alpha, threshold):
+    lower_is_better = not metric.endswith("per_second")
+    rows, regressions, underpowered = [], 0, False
+    for name in sorted(set(base) | set(cur)):
+        b = base.get(name, {}).get(metric)
+        c = cur.get(name, {}).get(metric)
+        if not b or not c:
+            rows.append((name, human(median(b)) if b else "-", human(median(c)) if c else "-",
+                         "", "", "new" if c else "gone"))
+            continue
+        mb, mc = median(b), median(c)
+        change = (mc - mb) / mb if mb else 0.0
+        p = mann_whitney_p(b, c)
+        # Smallest two-sided p the exact test can give for these sample sizes
+        underpowered |= 2.0 / math.comb(len(b) + len(c), len(b)) >= alpha
+        worse = change > 0 if lower_is_better else change < 0
+        if p < alpha and abs(change) > threshold:
+            verdict = "REGRESSION" if worse else "improved"
+            regressions += worse
+        elif p < alpha:
+            verdict = "~ (below threshold)"
+        else:
+            verdict = "~"
+        rows.append((name, human(mb), human(mc), f"{change * 100:+.1f}%", f"{p:.3f}", verdict))
+
+    header = ("benchmark", f"base {metric}", f"new {metric}", "change", "p", "")
+    widths = [max(len(str(row[i])) for row in rows + [header]) for i in range(len(header))]
+    fmt = "  ".join(f"{{:<{w}}}" if i == 0 else f"{{:>{w}}}" for i, w in enumerate(widths))
+    print(fmt.format(*header))
+    print(fmt.format(*("-" * w for w in widths)))
+    for row in rows:
+        print(fmt.format(*row))
+    print(f"\n{regressions} regression(s), alpha={alpha}, threshold={threshold * 100:.0f}%,"
+          f" {'lower' if lower_is_better else 'higher'} is better")
+    if underpowered:
+        print(f"warning: some benchmarks have too few repetitions to ever reach p < {alpha},"
+              " use --repetitions 5 or more", file=sys.stderr)
+    return regressions
+
+
+# ---- main --------------------------------------------------------------------
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.dirname(here)
+
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("command", choices=("baseline", "compare", "run"))
+    ap.add_argument("--build-dir", default=os.path.join(root, "build"))
+    ap.add_argument("--bench-dir", default=os.path.join(root, "bench"))
+    ap.add_argument("--store", default=os.path.join(root, "bench_baselines"),
+                    help="directory of per-host baselines")
+    ap.add_argument("--filter", default="", help="--benchmark_filter regex")
+    ap.add_argument("--only", default="", help="regex on executable names")
+    ap.add_argument("--repetitions", type=int, default=5)
+    ap.add_argument("--current", help="compare this saved run instead of running")
+    ap.add_argument("--out", help="also write the run to this file")
+    ap.add_argument("--metric", default="real_time_ns",
+                    help="real_time_ns (default) or any *per_second counter")
+    ap.add_argument("--alpha", type=float, default=0.05)
+    ap.add_argument("--threshold", type=float, default=0.05,
+                    help="relative change of the median below which nothing is flagged")
+    ap.add_argument("bench_args", nargs="*", help="extra arguments for every benchmark (after --)")
+    args = ap.parse_args()
+
+    fingerprint, desc = host_fingerprint()
+
+    if args.current:
+        run = load(args.current)
+    else:
+        exes = bench_executables(args.build_dir, args.bench_dir)
+        if args.only:
+            exes = [e for e in exes if re.search(args.only, os.path.basename(e))]
+        if not exes:
+            sys.exit(f"no benchmark executables found in {args.build_dir}")
+        run = {"fingerprint": fingerprint, "host": desc,
+               "results": run_benchmarks(exes, args.repetitions, args.filter, args.bench_args)}
+    if args.out:
+        save(args.out, run)
+
+    path = baseline_path(args.store, fingerprint)
+    if args.command == "baseline":
+        save(path, run)
+        print(f"baseline for {desc['host']} ({desc['cpu']}, {desc['cpus']} cpus) saved to {path}")
+        return 0
+    if args.command == "run":
+        return 0
+
+    if not os.path.exists(path):
+        sys.exit(f"no baseline for this host ({fingerprint}) in {args.store}, run 'baseline' first")
+    base = load(path)
+    if run.get("fingerprint", fingerprint) != base.get("fingerprint"):
+        print("warning: run and baseline come from different hosts", file=sys.stderr)
+    return 1 if compare(base["results"], run["results"], args.metric, args.alpha, args.threshold) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())